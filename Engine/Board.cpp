@@ -1,17 +1,87 @@
 #include "Board.h"
 #include <cstdint>
-#include <random>
 #include <iostream>
 #include "MoveGenerator.h"
 #include <stdexcept>
 #include <immintrin.h>
+#include <sstream>
+#include "Trace.h"
+
+thread_local Move moves[MAX_DEPTH][MAX_MOVES];
+
+//std::mt19937_64 as a constexpr class, so the Zobrist keys are computed by the compiler.
+//It gives the same sequence as the standard one, hashes and opening books stay the same
+class ConstexprMt19937_64 {
+	public:
+		constexpr explicit ConstexprMt19937_64(uint64_t seed) : state(), index(STATE_SIZE) {
+			state[0] = seed;
+			for (int i = 1; i < STATE_SIZE; i++) {
+				state[i] = 6364136223846793005ULL * (state[i - 1] ^ (state[i - 1] >> 62)) + i;
+			}
+		}
+
+		constexpr uint64_t operator()() {
+			if (index >= STATE_SIZE) {
+				twist();
+			}
+			uint64_t y = state[index++];
+			y ^= (y >> 29) & 0x5555555555555555ULL;
+			y ^= (y << 17) & 0x71D67FFFEDA60000ULL;
+			y ^= (y << 37) & 0xFFF7EEE000000000ULL;
+			return y ^ (y >> 43);
+		}
+
+	private:
+		static constexpr int STATE_SIZE = 312;
+		static constexpr int SHIFT_SIZE = 156;
+		uint64_t state[STATE_SIZE];
+		int index;
+
+		constexpr void twist() {
+			for (int i = 0; i < STATE_SIZE; i++) {
+				uint64_t x = (state[i] & 0xFFFFFFFF80000000ULL) | (state[(i + 1) % STATE_SIZE] & 0x7FFFFFFFULL);
+				uint64_t xA = x >> 1;
+				if (x & 1) {
+					xA ^= 0xB5026F5AA96619E9ULL;
+				}
+				state[i] = state[(i + SHIFT_SIZE) % STATE_SIZE] ^ xA;
+			}
+			index = 0;
+		}
+};
+
+struct ZobristKeys {
+	uint64_t pieces[12][64]; // 12 piece types 64 squares
+	uint64_t side;           // Side to move
+	uint64_t castling[16];   // Castling  rights states
+	uint64_t enPassant[8];   // En passant file
+};
 
-Move moves[MAX_DEPTH][MAX_MOVES];
+//The draw order is part of the keys, don't change it
+static constexpr ZobristKeys generateZobristKeys() {
+	ConstexprMt19937_64 rng(0xDEADBEEF); // fixed seed for reproducibility
+	ZobristKeys keys = {};
+
+	for (int piece = 0; piece < 12; ++piece) {
+		for (int square = 0; square < 64; ++square) {
+			keys.pieces[piece][square] = rng();
+		}
+	}
+	keys.side = rng();
+	for (int i = 0; i < 16; ++i) {
+		keys.castling[i] = rng();
+	}
+	for (int file = 0; file < 8; ++file) {
+		keys.enPassant[file] = rng();
+	}
+	return keys;
+}
 
-uint64_t ZobristTable[12][64]; // 12 piece types 64 squares
-uint64_t ZobristSide;          // Side to move
-uint64_t ZobristCastling[16];  // Castling  rights states
-uint64_t ZobristEnPassant[8];  // En passant file
+static constexpr ZobristKeys ZOBRIST_KEYS = generateZobristKeys();
+static constexpr auto& ZobristTable = ZOBRIST_KEYS.pieces;
+static constexpr uint64_t ZobristSide = ZOBRIST_KEYS.side;
+static constexpr auto& ZobristCastling = ZOBRIST_KEYS.castling;
+static constexpr auto& ZobristEnPassant = ZOBRIST_KEYS.enPassant;
 
 int pieceIndex(PieceType type, PieceColor color) {
     int base = (color == white) ? 0 : 6;
@@ -22,6 +92,18 @@ int Board::countPieces() const {
 	return _mm_popcnt_u64(this->getCombinedBoard(white) | this->getCombinedBoard(black));
 }
 
+bool Board::isRepetition(int repeats) const {
+	//Only positions with the same side to move and no irreversible move in between can match
+	int size = this->history.size();
+	int count = 0;
+	for (int i = size - 2; i >= 0 && i >= size - this->halfMoveClock; i -= 2) {
+		if (this->history[i].zobristHash == this->zobristHash && ++count >= repeats) {
+			return true;
+		}
+	}
+	return false;
+}
+
 int castlingRightsAfterMove(const Move& move, int oldCastling){
 	int newCastling = oldCastling;
 // Moving king removes both rights for that color
@@ -35,20 +117,49 @@ int castlingRightsAfterMove(const Move& move, int oldCastling){
     // Moving rooks removes relevant side
     if (move.pieceType == Rook) {
         if (move.pieceColor == white) {
-            if (move.from == 0) newCastling &= 0b1110; // a1 rook, remove Q
-            if (move.from == 7) newCastling &= 0b1101; // h1 rook, remove K
+            if (move.from == 0) newCastling &= 0b1101; // a1 rook, remove Q
+            if (move.from == 7) newCastling &= 0b1110; // h1 rook, remove K
         } else {
             if (move.from == 56) newCastling &= 0b0111; // a8 rook, remove q
             if (move.from == 63) newCastling &= 0b1011; // h8 rook, remove k
         }
     }
-	if (move.to == 0) newCastling &= 0b1110; // a1 rook, remove Q
-	if (move.to == 7) newCastling &= 0b1101; // h1 rook, remove K
+	if (move.to == 0) newCastling &= 0b1101; // a1 rook, remove Q
+	if (move.to == 7) newCastling &= 0b1110; // h1 rook, remove K
 	if (move.to == 56) newCastling &= 0b0111; // a8 rook, remove q
 	if (move.to == 63) newCastling &= 0b1011; // h8 rook, remove k
 	return newCastling;
 }
 
+//En passant only changes the position when a pawn of the side to move can actually capture
+static bool isEnPassantCapturable(int enPassantSquare, bool whiteCaptures, uint64_t capturingPawns){
+	if (enPassantSquare == -1){return false;}
+	const uint64_t fileA = 0x0101010101010101ULL;
+	const uint64_t fileH = 0x8080808080808080ULL;
+	uint64_t target = 1ULL << enPassantSquare;
+	uint64_t attackers = whiteCaptures ? ((target >> 7) & ~fileA) | ((target >> 9) & ~fileH)
+	                                   : ((target << 7) & ~fileH) | ((target << 9) & ~fileA);
+	return (attackers & capturingPawns) != 0;
+}
+
+uint64_t Board::computeZobrist() const{
+	uint64_t hash = 0;
+	for (int square = 0; square < 64; square++){
+		std::pair<PieceType, PieceColor> piece = this->getPieceTypeAtBit(square);
+		if (piece.first != None){
+			hash ^= ZobristTable[pieceIndex(piece.first, piece.second)][square];
+		}
+	}
+	if (!this->whiteToMove){
+		hash ^= ZobristSide;
+	}
+	hash ^= ZobristCastling[this->castlingRights];
+	if (isEnPassantCapturable(this->enPassantSquare, this->whiteToMove, this->whiteToMove ? this->whitePawns : this->blackPawns)){
+		hash ^= ZobristEnPassant[this->enPassantSquare % 8];
+	}
+	return hash;
+}
+
 void Board::parseFEN(std::string FEN){
 	int n = FEN.size();
 	int currentX = 0, currentY = 0;
@@ -87,6 +198,26 @@ void Board::parseFEN(std::string FEN){
 		
 	}
 	}
+
+	//Game state fields, missing trailing fields read as "w - - 0 0"
+	std::istringstream fields(FEN);
+	std::string placement, side = "w", castling = "-", passant = "-";
+	fields >> placement >> side >> castling >> passant >> this->halfMoveClock >> this->fullMoveNumber;
+
+	this->whiteToMove = side != "b";
+	this->castlingRights = 0;
+	for (char c : castling){
+		if (c == 'K'){this->castlingRights |= 1;}
+		else if (c == 'Q'){this->castlingRights |= 2;}
+		else if (c == 'k'){this->castlingRights |= 4;}
+		else if (c == 'q'){this->castlingRights |= 8;}
+	}
+	this->enPassantSquare = passant == "-" ? -1 : Move::stringToSquare(passant);
+
+	whitePieces = this->getCombinedBoard(white);
+	blackPieces = this->getCombinedBoard(black);
+	allPieces = whitePieces | blackPieces;
+	this->zobristHash = this->computeZobrist();
 }
 
 Board::Board() {
@@ -117,39 +248,12 @@ Board::Board() {
 
 	zobristHash = 0;
 
-	this->initZobristKeys();
-	
-	
 	history = {};
 	moveHistory = {};
 }
 
-void Board::initZobristKeys() {
-	std::mt19937_64 rng(0xDEADBEEF); // fixed seed for reproducibility
-	std::uniform_int_distribution<uint64_t> dist;
-
-	// Fill piece-square table
-	for (int piece = 0; piece < 12; ++piece) {
-		for (int square = 0; square < 64; ++square) {
-			ZobristTable[piece][square] = dist(rng);
-		}
-	}
-
-	// Side to move
-	ZobristSide = dist(rng);
-
-	// Castling rights (16 possibilities)
-	for (int i = 0; i < 16; ++i) {
-		ZobristCastling[i] = dist(rng);
-	}
-
-	// En passant files
-	for (int file = 0; file < 8; ++file) {
-		ZobristEnPassant[file] = dist(rng);
-	}
-}
-
 void Board::makeMove(const Move& move){
+	TRACE_SCOPE(MakeMove);
 	moveHistory.push_back(move);
 
 	BoardState state(this->castlingRights,this->enPassantSquare, this->halfMoveClock, this->
@@ -203,21 +307,8 @@ void Board::makeMove(const Move& move){
 
 
 
-	//Update castling rights
-	if (move.pieceType == King){
-		if (move.pieceColor == white){
-			this->castlingRights &= ~(1ULL << (0));
-			this->castlingRights &= ~(1ULL << (1));
-		}
-		else{
-			this->castlingRights &= ~(1ULL << (2));
-			this->castlingRights &= ~(1ULL << (3));
-		}
-	}
-	if(move.from == 0 || move.to == 0){this->castlingRights &= ~(1ULL << (1));}
-	else if(move.from == 7|| move.to == 7){this->castlingRights &= ~(1ULL << (0));}
-	else if(move.from == 56 || move.to == 56){this->castlingRights &= ~(1ULL << (3));}
-	else if(move.from == 63 || move.to == 63){this->castlingRights &= ~(1ULL << (2));}
+	//Update castling rights, shared with updateZobrist so the hash always matches
+	this->castlingRights = castlingRightsAfterMove(move, this->castlingRights);
 
 	//Apply castling move
 	if(move.pieceType == King && std::abs(move.from-move.to) == 2){
@@ -254,9 +345,15 @@ void Board::makeMove(const Move& move){
 
 	this->whiteToMove = !this->whiteToMove;
 
+#ifdef VERIFY_ZOBRIST
+	if (this->zobristHash != this->computeZobrist()){
+		throw std::runtime_error("zobrist hash drifted after makeMove " + move.toString());
+	}
+#endif
 }
 
 void Board::unmakeMove(const Move& move){
+	TRACE_SCOPE(UnmakeMove);
 	moveHistory.pop_back();
 	//Pop history back
 	if (this->history.size() == 0){
@@ -344,6 +441,11 @@ void Board::unmakeMove(const Move& move){
 	if (this->zobristHash != state.zobristHash){
 		throw std::invalid_argument("error with zobrist hash");
 	}
+#ifdef VERIFY_ZOBRIST
+	if (this->zobristHash != this->computeZobrist()){
+		throw std::runtime_error("zobrist hash drifted after unmakeMove " + move.toString());
+	}
+#endif
 }
 
 uint64_t* Board::getBoardOfType(PieceType type, PieceColor color){
@@ -405,6 +507,27 @@ void Board::updateZobrist(const Move& move) {
     }
 
 
+    // Rook jump when castling
+    if (move.pieceType == King && std::abs(move.from - move.to) == 2) {
+        int rookIdx = pieceIndex(Rook, move.pieceColor);
+        int rookFrom = move.to > move.from ? move.from + 3 : move.from - 4;
+        int rookTo = move.to > move.from ? move.from + 1 : move.from - 1;
+        zobristHash ^= ZobristTable[rookIdx][rookFrom];
+        zobristHash ^= ZobristTable[rookIdx][rookTo];
+    }
+
+    // En passant file, only hashed while a capture is possible
+    if (isEnPassantCapturable(this->enPassantSquare, this->whiteToMove, this->whiteToMove ? this->whitePawns : this->blackPawns)){
+        zobristHash ^= ZobristEnPassant[this->enPassantSquare % 8];
+    }
+    if (move.pieceType == Pawn && std::abs(move.from - move.to) == 16){
+        int newEnPassant = move.to + (move.pieceColor == white ? -8 : 8);
+        uint64_t enemyPawns = move.pieceColor == white ? this->blackPawns : this->whitePawns;
+        if (isEnPassantCapturable(newEnPassant, move.pieceColor == black, enemyPawns)){
+            zobristHash ^= ZobristEnPassant[newEnPassant % 8];
+        }
+    }
+
 	int newCastling = castlingRightsAfterMove(move,this->castlingRights);
 
     
@@ -439,6 +562,7 @@ void Board::setStartingPosition() {
 	blackPieces = blackPawns | blackRooks | blackKnights | blackBishops | blackQueens | blackKing;
 	allPieces = whitePieces | blackPieces;
 
+	zobristHash = computeZobrist();
 }
 
 void Board::setTestingPosition(){
@@ -459,13 +583,15 @@ void Board::setTestingPosition(){
     blackQueens  = 0;
     blackKing    = (1ULL << 63);
 	castlingRights = 0;
-	enPassantSquare = 0;
-	halfMoveClock = 0,
+	enPassantSquare = -1;
+	halfMoveClock = 0;
 
     whitePieces = whitePawns | whiteKnights | whiteBishops | whiteRooks | whiteQueens | whiteKing;
     blackPieces = blackPawns | blackKnights | blackBishops | blackRooks | blackQueens | blackKing;
     allPieces   = whitePieces | blackPieces;
 
+	zobristHash = computeZobrist();
+
 }
 
 //helper functions
@@ -15,7 +15,7 @@
 constexpr int MAX_DEPTH = 14;
 constexpr int MAX_MOVES = 218;
 
-extern Move moves[MAX_DEPTH][MAX_MOVES];  // just a declaration
+extern thread_local Move moves[MAX_DEPTH][MAX_MOVES];  // just a declaration, one buffer per thread
 
 
 
@@ -74,6 +74,9 @@ public:
 
 	int countPieces() const;
 
+	//True if the current position already appeared `repeats` times since the last capture or pawn move
+	bool isRepetition(int repeats = 1) const;
+
 	std::pair<PieceType, PieceColor> getPieceTypeAtBit(int bit) const;
 	char getLetterOfPieceType(PieceType type) const;
 
@@ -110,8 +113,9 @@ public:
 	int countMoves(int depth);
 
 
-	void initZobristKeys();
 	void updateZobrist(const Move& move);
+	//Full recomputation, used to seed the incremental hash and to verify it
+	uint64_t computeZobrist() const;
 
 	uint64_t* getBoardOfType(PieceType type, PieceColor color);
 
@@ -4,99 +4,101 @@
 #include "MoveGenerator.h"
 #include "Search.h"
 #include "Evaluator.h"
+#include "Trace.h"
 #include <immintrin.h>
 
 
-constexpr int PawnTable[64] = {
-      0,   0,   0,   0,   0,   0,   0,   0,
-     50,  50,  50,  50,  50,  50,  50,  50,
-     10,  10,  20,  30,  30,  20,  10,  10,
-      5,   5,  10,  25,  25,  10,   5,   5,
-      0,   0,   0,  20,  20,   0,   0,   0,
-      5,  -5, -10,   0,   0, -10,  -5,   5,
-      5,  10,  10, -20, -20,  10,  10,   5,
-      0,   0,   0,   0,   0,   0,   0,   0
-};
-
-constexpr int KnightTable[64] = {
-    -50,-40,-30,-30,-30,-30,-40,-50,
-    -40,-20,  0,  0,  0,  0,-20,-40,
-    -30,  0, 10, 15, 15, 10,  0,-30,
-    -30,  5, 15, 20, 20, 15,  5,-30,
-    -30,  0, 15, 20, 20, 15,  0,-30,
-    -30,  5, 10, 15, 15, 10,  5,-30,
-    -40,-20,  0,  5,  5,  0,-20,-40,
-    -50,-40,-30,-30,-30,-30,-40,-50
-};
-
-constexpr int BishopTable[64] = {
-    -20,-10,-10,-10,-10,-10,-10,-20,
-    -10,  5,  0,  0,  0,  0,  5,-10,
-    -10, 10, 10, 10, 10, 10, 10,-10,
-    -10,  0, 10, 10, 10, 10,  0,-10,
-    -10,  5,  5, 10, 10,  5,  5,-10,
-    -10,  0,  5, 10, 10,  5,  0,-10,
-    -10,  0,  0,  0,  0,  0,  0,-10,
-    -20,-10,-10,-10,-10,-10,-10,-20
-};
-
-constexpr int RookTable[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-     5, 10, 10, 10, 10, 10, 10,  5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-     0,  0,  0,  5,  5,  0,  0,  0
-};
-
-constexpr int QueenTable[64] = {
-    -20,-10,-10, -5, -5,-10,-10,-20,
-    -10,  0,  0,  0,  0,  0,  0,-10,
-    -10,  0,  5,  5,  5,  5,  0,-10,
-     -5,  0,  5,  5,  5,  5,  0, -5,
-      0,  0,  5,  5,  5,  5,  0, -5,
-    -10,  5,  5,  5,  5,  5,  0,-10,
-    -10,  0,  5,  0,  0,  0,  0,-10,
-    -20,-10,-10, -5, -5,-10,-10,-20
-};
-
-constexpr int KingTable[64] = {
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -20,-30,-30,-40,-40,-30,-30,-20,
-    -10,-20,-20,-20,-20,-20,-20,-10,
-     20, 20,  -10,  -10,  -10,  -10, 20, 20,
-     20, 30, 10,  0,  0, 10, 30, 20
-};
-
-
 inline int mirrorSquare(int sq) {
     return sq ^ 56; // flips rank
 }
 
+static uint64_t getPieceBoard(const Board& board, PieceColor color, int type){
+    switch (type) {
+    case Pawn:   return color == white ? board.whitePawns : board.blackPawns;
+    case Knight: return color == white ? board.whiteKnights : board.blackKnights;
+    case Bishop: return color == white ? board.whiteBishops : board.blackBishops;
+    case Rook:   return color == white ? board.whiteRooks : board.blackRooks;
+    case Queen:  return color == white ? board.whiteQueens : board.blackQueens;
+    default:     return color == white ? board.whiteKing : board.blackKing;
+    }
+}
+
 int Evaluator::evaluate(const Board& board){
+    TRACE_SCOPE(Evaluate);
 
     int score = 0;
     int whiteBishops = _mm_popcnt_u64(board.whiteBishops);
     int blackBishops = _mm_popcnt_u64(board.blackBishops);
-    if (whiteBishops >= 2) score += 30;
-    if (blackBishops >= 2) score -= 30;
-    score += (_mm_popcnt_u64(board.whitePawns) - _mm_popcnt_u64(board.blackPawns)) * PIECE_VALUES[0];
-    score += (_mm_popcnt_u64(board.whiteKnights) - _mm_popcnt_u64(board.blackKnights)) * PIECE_VALUES[1];
-    score += (whiteBishops - blackBishops) * PIECE_VALUES[2];
-    score += (_mm_popcnt_u64(board.whiteRooks) - _mm_popcnt_u64(board.blackRooks)) * PIECE_VALUES[3];
-    score += (_mm_popcnt_u64(board.whiteQueens) - _mm_popcnt_u64(board.blackQueens)) * PIECE_VALUES[4];
-    score += (_mm_popcnt_u64(board.whiteKing) - _mm_popcnt_u64(board.blackKing)) * PIECE_VALUES[5];
-    score += KingTable[board.getKingPosition(white)];
-    score -= KingTable[mirrorSquare(board.getKingPosition(black))];
+    if (whiteBishops >= 2) score += BISHOP_PAIR_BONUS;
+    if (blackBishops >= 2) score -= BISHOP_PAIR_BONUS;
+
+    for (int type = Pawn; type <= King; type++){
+        uint64_t whiteBoard = getPieceBoard(board, white, type);
+        uint64_t blackBoard = getPieceBoard(board, black, type);
+        if (type != King){
+            score += (int(_mm_popcnt_u64(whiteBoard)) - int(_mm_popcnt_u64(blackBoard))) * PIECE_VALUES[type];
+        }
 
-    
-    score += (board.whiteToMove ? 10 : -10);
+        //Tables are drawn from white's side, so white squares are mirrored
+        while (whiteBoard){
+            int square = __builtin_ctzll(whiteBoard);
+            whiteBoard &= whiteBoard - 1;
+            score += PIECE_SQUARE_TABLES[type][mirrorSquare(square)];
+        }
+        while (blackBoard){
+            int square = __builtin_ctzll(blackBoard);
+            blackBoard &= blackBoard - 1;
+            score -= PIECE_SQUARE_TABLES[type][square];
+        }
+    }
+
+    score += (board.whiteToMove ? TEMPO_BONUS : -TEMPO_BONUS);
     // Perspective: positive means white is better
     return score;
 
-}
\ No newline at end of file
+}
+
+int Evaluator::extractTerms(const Board& board, EvalTerm* terms){
+    int termCount = 0;
+
+    for (int type = Pawn; type <= King; type++){
+        uint64_t whiteBoard = getPieceBoard(board, white, type);
+        uint64_t blackBoard = getPieceBoard(board, black, type);
+        int difference = int(_mm_popcnt_u64(whiteBoard)) - int(_mm_popcnt_u64(blackBoard));
+        if (type != King && difference != 0){
+            terms[termCount++] = {int16_t(PARAM_MATERIAL + type), int16_t(difference)};
+        }
+
+        while (whiteBoard){
+            int square = __builtin_ctzll(whiteBoard);
+            whiteBoard &= whiteBoard - 1;
+            terms[termCount++] = {int16_t(PARAM_PST + type * 64 + mirrorSquare(square)), 1};
+        }
+        while (blackBoard){
+            int square = __builtin_ctzll(blackBoard);
+            blackBoard &= blackBoard - 1;
+            terms[termCount++] = {int16_t(PARAM_PST + type * 64 + square), -1};
+        }
+    }
+
+    int bishopPair = (_mm_popcnt_u64(board.whiteBishops) >= 2) - (_mm_popcnt_u64(board.blackBishops) >= 2);
+    if (bishopPair != 0){
+        terms[termCount++] = {PARAM_BISHOP_PAIR, int16_t(bishopPair)};
+    }
+    terms[termCount++] = {PARAM_TEMPO, int16_t(board.whiteToMove ? 1 : -1)};
+
+    return termCount;
+}
+
+void Evaluator::getParameters(int* params){
+    for (int type = Pawn; type < King; type++){
+        params[PARAM_MATERIAL + type] = PIECE_VALUES[type];
+    }
+    for (int type = Pawn; type <= King; type++){
+        for (int square = 0; square < 64; square++){
+            params[PARAM_PST + type * 64 + square] = PIECE_SQUARE_TABLES[type][square];
+        }
+    }
+    params[PARAM_BISHOP_PAIR] = BISHOP_PAIR_BONUS;
+    params[PARAM_TEMPO] = TEMPO_BONUS;
+}
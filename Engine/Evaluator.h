@@ -1,18 +1,34 @@
 #include "Board.h"
+#include "EvalParams.h"
+#include <cstdint>
 
 #pragma once
-constexpr int PIECE_VALUES[6] = {
-    100,  // Pawn
-    320,  // Knight
-    330,  // Bishop
-    500,  // Rook
-    900,  // Queen
-    20000 // King (arbitrary large)
+
+//Flat layout of every tunable weight, shared by evaluate() and the tuner.
+//The evaluation is linear: score = sum(params[term.index] * term.coefficient)
+enum EvalParamIndex {
+	PARAM_MATERIAL = 0,                   // Pawn..Queen, the king is never traded
+	PARAM_PST = PARAM_MATERIAL + 5,       // 6 tables of 64 squares
+	PARAM_BISHOP_PAIR = PARAM_PST + 6 * 64,
+	PARAM_TEMPO,
+	EVAL_PARAM_COUNT
 };
 
+struct EvalTerm {
+	int16_t index;
+	int16_t coefficient;
+};
 
+//5 material terms + one per piece + bishop pair + tempo
+constexpr int MAX_EVAL_TERMS = 5 + 32 + 2;
 
 class Evaluator{
 	public:
 		static int evaluate(const Board& board);
+
+		//Decomposes the evaluation of a position into weighted terms, returns the term count
+		static int extractTerms(const Board& board, EvalTerm* terms);
+
+		//Writes the compiled-in weights in EvalParamIndex layout
+		static void getParameters(int* params);
 };
@@ -4,6 +4,7 @@
 #include <tuple>
 #include <iostream>
 #include <optional>
+#include <cstdint>
 
 class Move
 {
@@ -31,6 +32,12 @@ public:
         if (promotionPiece != None){s+= ':';s+= pieceTypeNames[promotionPiece];}
         return s;
     }
+    //16 bit form: from | to << 6 | promotion piece << 12 (0 when there is none)
+    uint16_t pack() const {
+        if (from < 0) return 0;
+        int promotion = promotionPiece == None ? 0 : promotionPiece;
+        return uint16_t(from | (to << 6) | (promotion << 12));
+    }
     static int stringToSquare(std::string square) {
             return (square[0] - 'a') + 8 * (square[1] - '1');
         }
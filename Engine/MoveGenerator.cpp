@@ -2,7 +2,18 @@
 #include "Move.h"
 #include <intrin.h>
 #include "Board.h"
+#include "Trace.h"
 #include <bits/stdc++.h>
+#ifndef _MSC_VER
+#include <cpuid.h>
+#endif
+
+//Lets the PEXT lookups use BMI2 even when the rest of the engine is built without it
+#ifdef _MSC_VER
+#define TARGET_BMI2
+#else
+#define TARGET_BMI2 __attribute__((target("bmi2")))
+#endif
 
 
 MoveGenerator::MoveGenerator(Board& b, bool fast) : board(b){
@@ -65,6 +76,7 @@ void MoveGenerator::generatePseudoLegalMoves(Move (*moves)[MAX_MOVES], int& move
 }
 
 void MoveGenerator::generateLegalMoves(Move (*moves)[MAX_MOVES], int& moveCount , int currentDepth){
+    TRACE_SCOPE(GenerateLegalMoves);
     generatePseudoLegalMoves(moves, moveCount,currentDepth);
     int newCount = 0;
     for (int i = 0; i < moveCount; i++) {
@@ -78,6 +90,7 @@ void MoveGenerator::generateLegalMoves(Move (*moves)[MAX_MOVES], int& moveCount
 
 
 bool MoveGenerator::isLegal(Move& move){
+    TRACE_SCOPE(IsLegal);
     
     
     //-----------OPTION 1
@@ -104,13 +117,15 @@ void MoveGenerator::generateKingMoves(Move (*moves)[MAX_MOVES], int& moveCount,
                 board.getPieceTypeAtBit(1) == std::make_pair(None,white) &&
                 board.getPieceTypeAtBit(2) == std::make_pair(None,white) &&
                 board.getPieceTypeAtBit(3) == std::make_pair(None,white) && 
-                !this->isSquareAttacked(board.getKingPosition(white),black)){
+                !this->isSquareAttacked(board.getKingPosition(white),black) &&
+                !this->isSquareAttacked(3,black)){
                 moves[currentDepth][moveCount++] = Move(King,white,4,2);
             }
             if((board.castlingRights & (1ULL << 0)) != 0 &&
                 board.getPieceTypeAtBit(5) == std::make_pair(None,white) &&
                 board.getPieceTypeAtBit(6) == std::make_pair(None,white) &&
-                !this->isSquareAttacked(board.getKingPosition(white),black) ){
+                !this->isSquareAttacked(board.getKingPosition(white),black) &&
+                !this->isSquareAttacked(5,black)){
                 moves[currentDepth][moveCount++] = Move(King,white,4,6);
             }
         }else{
@@ -118,13 +133,15 @@ void MoveGenerator::generateKingMoves(Move (*moves)[MAX_MOVES], int& moveCount,
                 board.getPieceTypeAtBit(57) == std::make_pair(None,white) &&
                 board.getPieceTypeAtBit(58) == std::make_pair(None,white) &&
                 board.getPieceTypeAtBit(59) == std::make_pair(None,white) &&
-                !this->isSquareAttacked(board.getKingPosition(black),white)){
+                !this->isSquareAttacked(board.getKingPosition(black),white) &&
+                !this->isSquareAttacked(59,white)){
                 moves[currentDepth][moveCount++] = Move(King,black,60,58);
             }
             if((board.castlingRights & (1ULL << 2)) != 0 &&
                 board.getPieceTypeAtBit(61) == std::make_pair(None,white) &&
                 board.getPieceTypeAtBit(62) == std::make_pair(None,white) &&
-                !this->isSquareAttacked(board.getKingPosition(black),white)){
+                !this->isSquareAttacked(board.getKingPosition(black),white) &&
+                !this->isSquareAttacked(61,white)){
                 moves[currentDepth][moveCount++] = Move(King,black,60,62);
             }
         }
@@ -270,14 +287,7 @@ void MoveGenerator::generatePawnMoves(Move (*moves)[MAX_MOVES], int& moveCount,
 }
 
 
-uint64_t MoveGenerator::knightAttacks[64] = {0};
-uint64_t MoveGenerator::kingAttacks[64] = {0};
-
-uint64_t MoveGenerator::RookAttackTable[64][4096] = {0};
-uint64_t MoveGenerator::BishopAttackTable[64][512] = {0};
-
-
-int MoveGenerator::RookRelevantBits[64]=
+constexpr int MoveGenerator::RookRelevantBits[64]=
 {
 	52, 53, 53, 53, 53, 53, 53, 52,
 	53, 54, 54, 54, 54, 54, 54, 53,
@@ -289,7 +299,7 @@ int MoveGenerator::RookRelevantBits[64]=
 	53, 54, 54, 53, 53, 53, 53, 53
 };
 
-uint64_t MoveGenerator::RookMagics[64]=
+constexpr uint64_t MoveGenerator::RookMagics[64]=
 {
 	0x0080001020400080, 0x0040001000200040, 0x0080081000200080, 0x0080040800100080,
 	0x0080020400080080, 0x0080010200040080, 0x0080008001000200, 0x0080002040800100,
@@ -308,7 +318,7 @@ uint64_t MoveGenerator::RookMagics[64]=
 	0x00FFFCDDFCED714A, 0x007FFCDDFCED714A, 0x003FFFCDFFD88096, 0x0000040810002101,
 	0x0001000204080011, 0x0001000204000801, 0x0001000082000401, 0x0001FFFAABFAD1A2
 };
-uint64_t MoveGenerator::RookMasks[64]=
+constexpr uint64_t MoveGenerator::RookMasks[64]=
 {	
 	0x000101010101017E, 0x000202020202027C, 0x000404040404047A, 0x0008080808080876,
 	0x001010101010106E, 0x002020202020205E, 0x004040404040403E, 0x008080808080807E,
@@ -329,7 +339,7 @@ uint64_t MoveGenerator::RookMasks[64]=
 };
 
 //my original tables for bishops
-int MoveGenerator::BishopRelevantBits[64]=
+constexpr int MoveGenerator::BishopRelevantBits[64]=
 {
 	58, 59, 59, 59, 59, 59, 59, 58,
 	59, 59, 59, 59, 59, 59, 59, 59,
@@ -341,7 +351,7 @@ int MoveGenerator::BishopRelevantBits[64]=
 	58, 59, 59, 59, 59, 59, 59, 58
 };
 
-uint64_t MoveGenerator::BishopMagics[64]=
+constexpr uint64_t MoveGenerator::BishopMagics[64]=
 {
 	0x0002020202020200, 0x0002020202020000, 0x0004010202000000, 0x0004040080000000,
 	0x0001104000000000, 0x0000821040000000, 0x0000410410400000, 0x0000104104104000,
@@ -362,7 +372,7 @@ uint64_t MoveGenerator::BishopMagics[64]=
 };
 
 
-uint64_t MoveGenerator::BishopMasks[64]=
+constexpr uint64_t MoveGenerator::BishopMasks[64]=
 {
 	0x0040201008040200, 0x0000402010080400, 0x0000004020100A00, 0x0000000040221400,
 	0x0000000002442800, 0x0000000204085000, 0x0000020408102000, 0x0002040810204000,
@@ -384,222 +394,260 @@ uint64_t MoveGenerator::BishopMasks[64]=
 
 
 
-void MoveGenerator::initKnightAttacks(){
+static constexpr std::array<uint64_t, 64> generateLeaperAttacks(const int (&dr)[8], const int (&df)[8]){
+    std::array<uint64_t, 64> table = {};
     for(int sq=0;sq<64;sq++){
         int r = sq/8, f = sq%8;
         uint64_t attacks = 0;
-        // all 8 possible jumps
-        int dr[8] = {2,1,-1,-2,-2,-1,1,2};
-        int df[8] = {1,2,2,1,-1,-2,-2,-1};
         for(int i=0;i<8;i++){
             int nr=r+dr[i], nf=f+df[i];
             if(nr>=0 && nr<8 && nf>=0 && nf<8) attacks |= 1ULL<<(nr*8+nf);
         }
-        knightAttacks[sq] = attacks;
+        table[sq] = attacks;
     }
+    return table;
 }
 
-void MoveGenerator::initKingAttacks(){
-    for(int sq=0;sq<64;sq++){
-        int r = sq/8, f = sq%8;
-        uint64_t attacks = 0;
-        // all 8 possible jumps
-        int dr[8] = { 1,  1,  0, -1, -1, -1,  0,  1 };
-        int df[8] = { 0,  1,  1,  1,  0, -1, -1, -1 };
-
-        for(int i=0;i<8;i++){
-            int nr=r+dr[i], nf=f+df[i];
-            if(nr>=0 && nr<8 && nf>=0 && nf<8) attacks |= 1ULL<<(nr*8+nf);
+// all 8 possible jumps
+static constexpr int KNIGHT_DR[8] = {2,1,-1,-2,-2,-1,1,2};
+static constexpr int KNIGHT_DF[8] = {1,2,2,1,-1,-2,-2,-1};
+static constexpr int KING_DR[8] = { 1,  1,  0, -1, -1, -1,  0,  1 };
+static constexpr int KING_DF[8] = { 0,  1,  1,  1,  0, -1, -1, -1 };
+
+constexpr std::array<uint64_t, 64> MoveGenerator::knightAttacks = generateLeaperAttacks(KNIGHT_DR, KNIGHT_DF);
+constexpr std::array<uint64_t, 64> MoveGenerator::kingAttacks = generateLeaperAttacks(KING_DR, KING_DF);
+
+enum PawnTable { PAWN_PUSH, PAWN_DOUBLE, PAWN_CAPTURES };
+
+static constexpr std::array<uint64_t, 64> generatePawnTable(PieceColor color, PawnTable kind){
+    std::array<uint64_t, 64> table = {};
+    for (int sq = 0; sq < 64; sq++){
+        int rank = sq / 8, file = sq % 8;
+        //Ranks seen from the pawn's side, so both colors push "up"
+        int forward = color == white ? 8 : -8;
+        int relativeRank = color == white ? rank : 7 - rank;
+        if (relativeRank == 7) {
+            continue;
         }
-        kingAttacks[sq] = attacks;
-    }
-}
-
-void MoveGenerator::initSlidingAttacks(){
-
-    for(int sq=0; sq<64; sq++) {
-        
-        // Masks
-        RookMasks[sq] = generateRookMask(sq);
-        BishopMasks[sq] = generateBishopMask(sq);
-        
 
-        // Rook occupancy
-        auto rookOccs = generateOccupancies(RookMasks[sq]);
-        for(auto occ : rookOccs) {
-            int index = (int)(((occ & RookMasks[sq]) * RookMagics[sq]) >> (RookRelevantBits[sq]));
-            if (index >= 4096){std::cerr << index << std::endl;}
-            RookAttackTable[sq][index] = rookAttacksOnTheFly(sq, occ);
+        uint64_t bits = 0ULL;
+        if (kind == PAWN_PUSH) {
+            bits |= 1ULL << (sq + forward);
         }
-        
-        // Bishop occupancy
-        auto bishopOccs = generateOccupancies(BishopMasks[sq]);
-        for(auto occ : bishopOccs) {
-            int index = (int)(((occ & BishopMasks[sq]) * BishopMagics[sq]) >> (BishopRelevantBits[sq]));
-            BishopAttackTable[sq][index] = bishopAttacksOnTheFly(sq, occ);
+        else if (kind == PAWN_DOUBLE && relativeRank == 1) {
+            bits |= 1ULL << (sq + 2 * forward);
+        }
+        else if (kind == PAWN_CAPTURES) {
+            if (file > 0) bits |= 1ULL << (sq + forward - 1);
+            if (file < 7) bits |= 1ULL << (sq + forward + 1);
         }
+        table[sq] = bits;
     }
+    return table;
 }
 
-uint64_t MoveGenerator::WhitePawnPush[64] = {};    // single-square push
-uint64_t MoveGenerator::WhitePawnDouble[64] = {};  // double push (only from rank 2)
-uint64_t MoveGenerator::WhitePawnAttacks[64] = {};
-
-uint64_t MoveGenerator::BlackPawnPush[64] = {};    // single-square push
-uint64_t MoveGenerator::BlackPawnDouble[64] = {};  // double push (only from rank 2)
-uint64_t MoveGenerator::BlackPawnAttacks[64] = {};
-
-void MoveGenerator::initPawnAttacks(){
-    for (int row = 0; row < 8; row++){
-        for (int col = 0; col < 8; col++){
-            int bitIndex = (7 - row) * 8 + col;
-
-            uint64_t whitePush = 0ULL;
-            uint64_t whiteDouble = 0ULL;
-            uint64_t whiteAttack = 0ULL;
-
-            // Single push (one rank up)
-            if (row > 0) {
-                whitePush |= 1ULL << (bitIndex + 8);
-            }
-
-            // Double push from rank 2 (row = 6)
-            if (row == 6) {
-                whiteDouble |= 1ULL << (bitIndex + 16);
-            }
-
-            // Diagonal captures
-            if (row > 0 && col > 0) {
-                whiteAttack |= 1ULL << (bitIndex + 7);  // left capture
-            }
-            if (row > 0 && col < 7) {
-                whiteAttack |= 1ULL << (bitIndex + 9);  // right capture
-            }
+constexpr std::array<uint64_t, 64> MoveGenerator::WhitePawnPush = generatePawnTable(white, PAWN_PUSH);
+constexpr std::array<uint64_t, 64> MoveGenerator::WhitePawnDouble = generatePawnTable(white, PAWN_DOUBLE);
+constexpr std::array<uint64_t, 64> MoveGenerator::WhitePawnAttacks = generatePawnTable(white, PAWN_CAPTURES);
 
-            uint64_t blackPush = 0ULL;
-            uint64_t blackDouble = 0ULL;
-            uint64_t blackAttack = 0ULL;
+constexpr std::array<uint64_t, 64> MoveGenerator::BlackPawnPush = generatePawnTable(black, PAWN_PUSH);
+constexpr std::array<uint64_t, 64> MoveGenerator::BlackPawnDouble = generatePawnTable(black, PAWN_DOUBLE);
+constexpr std::array<uint64_t, 64> MoveGenerator::BlackPawnAttacks = generatePawnTable(black, PAWN_CAPTURES);
 
-            // Single push (one rank up)
-            if (row < 7) {
-                blackPush |= 1ULL << (bitIndex - 8);
-            }
+//Rays are indexed by direction: north, east, northeast, northwest run towards higher squares,
+//south, west, southeast, southwest towards lower ones
+enum RayDirection { NORTH, EAST, NORTHEAST, NORTHWEST, SOUTH, WEST, SOUTHEAST, SOUTHWEST };
+static constexpr int RAY_DR[8] = { 1, 0, 1,  1, -1,  0, -1, -1 };
+static constexpr int RAY_DF[8] = { 0, 1, 1, -1,  0, -1,  1, -1 };
 
-            // Double push from rank 2 (row = 6)
-            if (row == 1) {
-                blackDouble |= 1ULL << (bitIndex - 16);
-            }
+//Squares from sq to the edge of the board in every direction, sq itself excluded
+struct RayTable {
+    uint64_t rays[8][64];
+};
 
-            // Diagonal captures
-            if (row < 7  && col < 7) {
-                blackAttack |= 1ULL << (bitIndex - 7);  // left capture
-            }
-            if (row < 7 && col > 0 ) {
-                blackAttack |= 1ULL << (bitIndex - 9);  // right capture
+static constexpr RayTable generateRays(){
+    RayTable table = {};
+    for (int direction = 0; direction < 8; direction++) {
+        for (int sq = 0; sq < 64; sq++) {
+            for (int r = sq/8 + RAY_DR[direction], f = sq%8 + RAY_DF[direction]; r >= 0 && r < 8 && f >= 0 && f < 8;
+                r += RAY_DR[direction], f += RAY_DF[direction]) {
+                table.rays[direction][sq] |= 1ULL << (r*8 + f);
             }
-
-            WhitePawnPush[bitIndex] = whitePush;
-            WhitePawnDouble[bitIndex] = whiteDouble;  // double push (only from rank 2)
-            WhitePawnAttacks[bitIndex] = whiteAttack;
-
-            BlackPawnPush[bitIndex] = blackPush;    // single-square push
-            BlackPawnDouble[bitIndex] = blackDouble;  // double push (only from rank 2)
-            BlackPawnAttacks[bitIndex] = blackAttack;
-            
         }
     }
-
+    return table;
 }
 
-uint64_t MoveGenerator::generateRookMask(int square) {
-    uint64_t attacks = 0ULL;
-    int rank = square / 8, file = square % 8;
-
-    // horizontal
-    for (int f = file + 1; f <= 6; f++) attacks |= 1ULL << (rank*8 + f);
-    for (int f = file - 1; f >= 1; f--) attacks |= 1ULL << (rank*8 + f);
+static constexpr RayTable RAYS = generateRays();
 
-    // vertical
-    for (int r = rank + 1; r <= 6; r++) attacks |= 1ULL << (r*8 + file);
-    for (int r = rank - 1; r >= 1; r--) attacks |= 1ULL << (r*8 + file);
-    return attacks;
+//A ray cut off after its first blocker. No loop over the squares, the compiler has to evaluate
+//this for every entry of the sliding tables and would hit its constexpr step limit otherwise
+static constexpr uint64_t rayAttacks(RayDirection direction, int sq, uint64_t blockers) {
+    uint64_t ray = RAYS.rays[direction][sq];
+    uint64_t hit = ray & blockers;
+    if (hit == 0) {
+        return ray;
+    }
+    if (direction < SOUTH) {
+        uint64_t first = hit & (0 - hit);
+        return ray & ((first - 1) | first);
+    }
+    // smear the highest blocker down, everything below it is hidden
+    hit |= hit >> 1;
+    hit |= hit >> 2;
+    hit |= hit >> 4;
+    hit |= hit >> 8;
+    hit |= hit >> 16;
+    hit |= hit >> 32;
+    return ray & ~(hit >> 1);
 }
 
-uint64_t MoveGenerator::generateBishopMask(int square) {
-    uint64_t attacks = 0ULL;
-    int rank = square / 8, file = square % 8;
-
-    // NE
-    for (int r=rank+1,f=file+1; r<=6 && f<=6; r++, f++) attacks |= 1ULL << (r*8+f);
-    // NW
-    for (int r=rank+1,f=file-1; r<=6 && f>=1; r++, f--) attacks |= 1ULL << (r*8+f);
-    // SE
-    for (int r=rank-1,f=file+1; r>=1 && f<=6; r--, f++) attacks |= 1ULL << (r*8+f);
-    // SW
-    for (int r=rank-1,f=file-1; r>=1 && f>=1; r--, f--) attacks |= 1ULL << (r*8+f);
-
-    return attacks;
+static constexpr uint64_t rookAttacksOnTheFly(int square, uint64_t blockers) {
+    return rayAttacks(NORTH, square, blockers) | rayAttacks(EAST, square, blockers)
+        | rayAttacks(SOUTH, square, blockers) | rayAttacks(WEST, square, blockers);
 }
 
-std::vector<uint64_t> MoveGenerator::generateOccupancies(uint64_t mask){
-    std::vector<uint64_t> occupancies;
-    int bits[12]; // maximum relevant squares
-    int numBits = 0;
+static constexpr uint64_t bishopAttacksOnTheFly(int square, uint64_t blockers) {
+    return rayAttacks(NORTHEAST, square, blockers) | rayAttacks(NORTHWEST, square, blockers)
+        | rayAttacks(SOUTHEAST, square, blockers) | rayAttacks(SOUTHWEST, square, blockers);
+}
 
-    for (int i=0; i<64; i++)
-        if (mask & (1ULL<<i)) bits[numBits++] = i;
+//Walks every subset of each square's mask (carry rippler) and stores its attacks at the magic index.
+//Fancy magics: a square only gets the 2^(64 - shift) entries its index can reach, packed behind the
+//previous square's, instead of every square taking as many as the worst one
+template <size_t Size>
+static constexpr PackedAttackTable<Size> generateMagicTable(bool rook, const uint64_t* masks,
+    const uint64_t* magics, const int* shifts){
+    PackedAttackTable<Size> table = {};
+    uint32_t offset = 0;
+    for(int sq=0; sq<64; sq++) {
+        table.offsets[sq] = offset;
+        uint64_t occ = 0;
+        do {
+            uint64_t index = (occ * magics[sq]) >> shifts[sq];
+            table.attacks[offset + index] = rook ? rookAttacksOnTheFly(sq, occ) : bishopAttacksOnTheFly(sq, occ);
+            occ = (occ - masks[sq]) & masks[sq];
+        } while (occ != 0);
+        offset += uint32_t(1) << (64 - shifts[sq]);
+    }
+    //Also stops the build if the entry counts in the header don't match the shifts
+    if (offset != Size) {
+        throw std::logic_error("Magic table size does not match the shifts");
+    }
+    return table;
+}
 
-    int count = 1 << numBits; // 2^numBits
-    for (int index=0; index<count; index++) {
+constexpr PackedAttackTable<ROOK_MAGIC_ENTRIES> MoveGenerator::RookAttackTable =
+    generateMagicTable<ROOK_MAGIC_ENTRIES>(true, RookMasks, RookMagics, RookRelevantBits);
+constexpr PackedAttackTable<BISHOP_MAGIC_ENTRIES> MoveGenerator::BishopAttackTable =
+    generateMagicTable<BISHOP_MAGIC_ENTRIES>(false, BishopMasks, BishopMagics, BishopRelevantBits);
+
+//PEXT gathers the blockers' bits in mask order, which is the order the carry rippler walks the subsets in.
+//Every square needs exactly 2^relevant bits entries, no magics and no shifts
+template <size_t Size>
+static constexpr PackedAttackTable<Size> generatePextTable(bool rook, const uint64_t* masks){
+    PackedAttackTable<Size> table = {};
+    uint32_t offset = 0;
+    for(int sq=0; sq<64; sq++) {
+        table.offsets[sq] = offset;
         uint64_t occ = 0;
-        for (int j=0; j<numBits; j++)
-            if (index & (1<<j)) occ |= 1ULL << bits[j];
-        occupancies.push_back(occ);
+        do {
+            table.attacks[offset++] = rook ? rookAttacksOnTheFly(sq, occ) : bishopAttacksOnTheFly(sq, occ);
+            occ = (occ - masks[sq]) & masks[sq];
+        } while (occ != 0);
+    }
+    //Also stops the build if the entry counts in the header don't match the masks
+    if (offset != Size) {
+        throw std::logic_error("PEXT table size does not match the masks");
     }
-    return occupancies;
+    return table;
+}
+
+constexpr PackedAttackTable<ROOK_PEXT_ENTRIES> MoveGenerator::RookPextTable =
+    generatePextTable<ROOK_PEXT_ENTRIES>(true, RookMasks);
+constexpr PackedAttackTable<BISHOP_PEXT_ENTRIES> MoveGenerator::BishopPextTable =
+    generatePextTable<BISHOP_PEXT_ENTRIES>(false, BishopMasks);
+
+//squareAttacks is the square's part of a PEXT table
+TARGET_BMI2 static uint64_t pextLookup(const uint64_t* squareAttacks, uint64_t occupancy, uint64_t mask) {
+    return squareAttacks[_pext_u64(occupancy, mask)];
 }
 
-uint64_t MoveGenerator::rookAttacksOnTheFly(int square, uint64_t blockers) {
-    uint64_t attacks = 0ULL;
-    int rank = square / 8, file = square % 8;
+static void cpuid(unsigned int leaf, unsigned int regs[4]) {
+#ifdef _MSC_VER
+    __cpuidex(reinterpret_cast<int*>(regs), leaf, 0);
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
 
-    // rays
-    for (int r = rank+1; r < 8; r++) { int sq = r*8+file; attacks |= 1ULL<<sq; if (blockers & (1ULL<<sq)) break; }
-    for (int r = rank-1; r >= 0; r--) { int sq = r*8+file; attacks |= 1ULL<<sq; if (blockers & (1ULL<<sq)) break; }
-    for (int f = file+1; f < 8; f++) { int sq = rank*8+f; attacks |= 1ULL<<sq; if (blockers & (1ULL<<sq)) break; }
-    for (int f = file-1; f >= 0; f--) { int sq = rank*8+f; attacks |= 1ULL<<sq; if (blockers & (1ULL<<sq)) break; }
+static bool detectBmi2() {
+    unsigned int regs[4];
+    cpuid(0, regs);
+    if (regs[0] < 7) {
+        return false;
+    }
+    cpuid(7, regs);
+    return (regs[1] >> 8) & 1; // EBX bit 8
+}
 
-    return attacks;
+//CPUID is slow, under a hypervisor it even traps, so it only runs once
+bool MoveGenerator::cpuHasBmi2() {
+    static const bool supported = detectBmi2();
+    return supported;
 }
 
-uint64_t MoveGenerator::bishopAttacksOnTheFly(int sq, uint64_t blockers) {
-    uint64_t attacks=0ULL;
-    int rank=sq/8, file=sq%8;
+//AMD before Zen 3 has BMI2 but runs PEXT in microcode, far slower than a magic multiply
+static bool cpuHasFastPext() {
+    if (!MoveGenerator::cpuHasBmi2()) {
+        return false;
+    }
+    unsigned int regs[4];
+    cpuid(0, regs);
+    bool amd = regs[1] == 0x68747541 && regs[3] == 0x69746E65 && regs[2] == 0x444D4163; // "AuthenticAMD"
+    if (!amd) {
+        return true;
+    }
+    cpuid(1, regs);
+    unsigned int family = (regs[0] >> 8) & 0xF;
+    if (family == 0xF) {
+        family += (regs[0] >> 20) & 0xFF;
+    }
+    return family >= 0x19;
+}
 
-    for(int r=rank+1,f=file+1; r<8 && f<8; r++,f++){ attacks|=1ULL<<(r*8+f); if(blockers & (1ULL<<(r*8+f))) break; }
-    for(int r=rank+1,f=file-1; r<8 && f>=0; r++,f--){ attacks|=1ULL<<(r*8+f); if(blockers & (1ULL<<(r*8+f))) break; }
-    for(int r=rank-1,f=file+1; r>=0 && f<8; r--,f++){ attacks|=1ULL<<(r*8+f); if(blockers & (1ULL<<(r*8+f))) break; }
-    for(int r=rank-1,f=file-1; r>=0 && f>=0; r--,f--){ attacks|=1ULL<<(r*8+f); if(blockers & (1ULL<<(r*8+f))) break; }
+SliderBackend MoveGenerator::sliderBackend = cpuHasFastPext() ? SliderBackend::Pext : SliderBackend::Magic;
 
-    return attacks;
+bool MoveGenerator::setSliderBackend(SliderBackend backend) {
+    if (backend == SliderBackend::Pext && !cpuHasBmi2()) {
+        return false;
+    }
+    sliderBackend = backend;
+    return true;
 }
 
 //IMPORTANT
 //-------------------------
 //STILL HAVE TO MASK OUT OWN PIECES attacks & ~ownPieces
 uint64_t MoveGenerator::getRookAttacks(int square, uint64_t occupancy) {
+    if (sliderBackend == SliderBackend::Pext) {
+        return pextLookup(RookPextTable.attacks + RookPextTable.offsets[square], occupancy, RookMasks[square]);
+    }
     uint64_t blockers = occupancy & RookMasks[square];
     uint64_t index = (blockers * RookMagics[square]) >> (RookRelevantBits[square]);
 
-    return RookAttackTable[square][index];
+    return RookAttackTable.attacks[RookAttackTable.offsets[square] + index];
 
 }
 
 uint64_t MoveGenerator::getBishopAttacks(int square, uint64_t occupancy) {
+    if (sliderBackend == SliderBackend::Pext) {
+        return pextLookup(BishopPextTable.attacks + BishopPextTable.offsets[square], occupancy, BishopMasks[square]);
+    }
     uint64_t blockers = occupancy & BishopMasks[square];
     uint64_t index = (blockers * BishopMagics[square]) >> (BishopRelevantBits[square]);
 
-    return BishopAttackTable[square][index];
+    return BishopAttackTable.attacks[BishopAttackTable.offsets[square] + index];
 }
 
 uint64_t MoveGenerator::getQueenAttacks(int square, uint64_t occupancy) {
@@ -1,10 +1,30 @@
 #include "Board.h"
 #include "Move.h"
-#include <vector>
+#include <array>
 #include <cstdint>
 
 #pragma once
 
+//Attacks of one slider for every square packed into one array, each square starts at its offset
+template <size_t Size>
+struct PackedAttackTable {
+	uint32_t offsets[64];
+	uint64_t attacks[Size];
+};
+
+//Sum of 2^(64 - shift) over all squares, some rook magics get away with fewer bits than their mask has.
+//About 800KB for both pieces
+constexpr size_t ROOK_MAGIC_ENTRIES = 96256;
+constexpr size_t BISHOP_MAGIC_ENTRIES = 5248;
+//Sum of 2^relevant bits over all squares
+constexpr size_t ROOK_PEXT_ENTRIES = 102400;
+constexpr size_t BISHOP_PEXT_ENTRIES = 5248;
+
+//How getRookAttacks/getBishopAttacks turn the blockers into a table index
+enum class SliderBackend {
+	Magic,	// multiply by a magic and shift, works everywhere
+	Pext	// BMI2 PEXT, no magics needed. Only fast on Intel since Haswell and AMD since Zen 3
+};
 
 class MoveGenerator{
 	public:
@@ -16,36 +36,50 @@ class MoveGenerator{
 		bool isSquareAttacked(int square, PieceColor oppositeColor) const;
 
 		bool isLegal(Move& move);
-		//Initializers for lookups and magic
-		static void initKnightAttacks();
-		static void initKingAttacks();
-		static void initSlidingAttacks();
-		static void initPawnAttacks();
-		
+
+		//Attack lookups, also used by the notation code to find the pieces that reach a square
+		static uint64_t getRookAttacks(int square, uint64_t occupancy);
+		static uint64_t getBishopAttacks(int square, uint64_t occupancy);
+		static uint64_t getQueenAttacks(int square, uint64_t occupancy);
+		static uint64_t getKnightAttacks(int square) { return knightAttacks[square]; }
+		static uint64_t getKingAttacks(int square) { return kingAttacks[square]; }
+		//Squares a pawn of the given color on square captures on
+		static uint64_t getPawnCaptures(int square, PieceColor color) { return color == white ? WhitePawnAttacks[square] : BlackPawnAttacks[square]; }
+
+		//Pext is picked at startup when the CPU runs it fast. Switching to Pext fails on a CPU without BMI2.
+		//Don't switch while a search is running
+		static bool setSliderBackend(SliderBackend backend);
+		static SliderBackend getSliderBackend() { return sliderBackend; }
+		static bool cpuHasBmi2();
+
 
 	private:
     		Board& board;
 			bool fast;
 
 
-			static uint64_t knightAttacks[64]; // all squares a knight can jump to
-			static uint64_t kingAttacks[64];   // all squares a king can move to
-			static uint64_t RookAttackTable[64][4096];
-			static uint64_t BishopAttackTable[64][512];
-			static uint64_t RookMasks[64];
-			static uint64_t BishopMasks[64];
-			static uint64_t RookMagics[64];
-			static uint64_t BishopMagics[64];
-			static int RookRelevantBits[64];
-			static int BishopRelevantBits[64];
+			//All lookup tables are generated at compile time and live in read-only data, nothing to initialize
+			static const std::array<uint64_t, 64> knightAttacks; // all squares a knight can jump to
+			static const std::array<uint64_t, 64> kingAttacks;   // all squares a king can move to
+			static const PackedAttackTable<ROOK_MAGIC_ENTRIES> RookAttackTable;
+			static const PackedAttackTable<BISHOP_MAGIC_ENTRIES> BishopAttackTable;
+			static const uint64_t RookMasks[64];
+			static const uint64_t BishopMasks[64];
+			static const uint64_t RookMagics[64];
+			static const uint64_t BishopMagics[64];
+			static const int RookRelevantBits[64];
+			static const int BishopRelevantBits[64];
+			static const PackedAttackTable<ROOK_PEXT_ENTRIES> RookPextTable;
+			static const PackedAttackTable<BISHOP_PEXT_ENTRIES> BishopPextTable;
+			static SliderBackend sliderBackend;
 
-			static uint64_t WhitePawnPush[64];    // single-square push
-			static uint64_t WhitePawnDouble[64];  // double push (only from rank 2)
-			static uint64_t WhitePawnAttacks[64]; // diagonal captures
+			static const std::array<uint64_t, 64> WhitePawnPush;    // single-square push
+			static const std::array<uint64_t, 64> WhitePawnDouble;  // double push (only from rank 2)
+			static const std::array<uint64_t, 64> WhitePawnAttacks; // diagonal captures
 
-			static uint64_t BlackPawnPush[64];    // single-square push
-			static uint64_t BlackPawnDouble[64];  // double push (only from rank 2)
-			static uint64_t BlackPawnAttacks[64]; // diagonal captures
+			static const std::array<uint64_t, 64> BlackPawnPush;    // single-square push
+			static const std::array<uint64_t, 64> BlackPawnDouble;  // double push (only from rank 2)
+			static const std::array<uint64_t, 64> BlackPawnAttacks; // diagonal captures
 
 
 
@@ -66,15 +100,6 @@ class MoveGenerator{
     		
 
 
-			static uint64_t generateRookMask(int sq);
-			static uint64_t generateBishopMask(int sq);
-			static  std::vector<uint64_t> generateOccupancies(uint64_t mask);
-			static uint64_t rookAttacksOnTheFly(int square, uint64_t blockers);
-			static uint64_t bishopAttacksOnTheFly(int square, uint64_t blockers);
-
-			static uint64_t getRookAttacks(int square, uint64_t occupancy);
-			static uint64_t getBishopAttacks(int square, uint64_t occupancy);
-			static uint64_t getQueenAttacks(int square, uint64_t occupancy);
 			uint64_t getPawnAttacks(int square, uint64_t combinedSame, uint64_t combinedOpposite) const;
 
 };
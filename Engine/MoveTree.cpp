@@ -1,11 +0,0 @@
-#include "MoveTree.h"
-
-MoveNode::MoveNode(std::string val){
-    this->value = val;
-    this->children = {};
-}
-
-MoveNode::MoveNode(){
-    this->value = "";
-    this->children = {};
-}
\ No newline at end of file
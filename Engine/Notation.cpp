@@ -0,0 +1,399 @@
+#include "Notation.h"
+#include "MoveGenerator.h"
+#include <cstdlib>
+
+static PieceColor opposite(PieceColor color) {
+    return color == white ? black : white;
+}
+
+static bool isFile(char c) { return c >= 'a' && c <= 'h'; }
+static bool isRank(char c) { return c >= '1' && c <= '8'; }
+
+static uint64_t fileMask(int file) { return 0x0101010101010101ULL << file; }
+static uint64_t rankMask(int rank) { return 0xFFULL << (8 * rank); }
+
+static PieceType pieceFromLetter(char c) {
+    switch (c) {
+        case 'N': return Knight;
+        case 'B': return Bishop;
+        case 'R': return Rook;
+        case 'Q': return Queen;
+        case 'K': return King;
+        default: return None;
+    }
+}
+
+static const char PIECE_LETTERS[] = "PNBRQK";
+
+//The six bitboards of one side, indexed by PieceType
+static void getPieces(const Board& board, PieceColor color, uint64_t* pieces) {
+    if (color == white) {
+        pieces[Pawn] = board.whitePawns; pieces[Knight] = board.whiteKnights; pieces[Bishop] = board.whiteBishops;
+        pieces[Rook] = board.whiteRooks; pieces[Queen] = board.whiteQueens; pieces[King] = board.whiteKing;
+    }
+    else {
+        pieces[Pawn] = board.blackPawns; pieces[Knight] = board.blackKnights; pieces[Bishop] = board.blackBishops;
+        pieces[Rook] = board.blackRooks; pieces[Queen] = board.blackQueens; pieces[King] = board.blackKing;
+    }
+}
+
+static uint64_t allPieces(const uint64_t* pieces) {
+    return pieces[Pawn] | pieces[Knight] | pieces[Bishop] | pieces[Rook] | pieces[Queen] | pieces[King];
+}
+
+//Pieces of the given color that attack the square
+static uint64_t attackersOf(int square, const uint64_t* pieces, PieceColor color, uint64_t occupancy) {
+    return (MoveGenerator::getKnightAttacks(square) & pieces[Knight])
+        | (MoveGenerator::getKingAttacks(square) & pieces[King])
+        | (MoveGenerator::getPawnCaptures(square, opposite(color)) & pieces[Pawn])
+        | (MoveGenerator::getBishopAttacks(square, occupancy) & (pieces[Bishop] | pieces[Queen]))
+        | (MoveGenerator::getRookAttacks(square, occupancy) & (pieces[Rook] | pieces[Queen]));
+}
+
+static bool isAttackedBy(int square, const uint64_t* pieces, PieceColor color, uint64_t occupancy) {
+    return attackersOf(square, pieces, color, occupancy) != 0;
+}
+
+//True if moving from -> to doesn't leave the mover's king attacked. capturedSquare differs from `to` for en passant
+static bool leavesKingSafe(const uint64_t* own, const uint64_t* enemy, PieceColor us, int from, int to, int capturedSquare) {
+    uint64_t captured = 1ULL << capturedSquare;
+    uint64_t enemyAfter[6];
+    for (int type = Pawn; type <= King; type++) {
+        enemyAfter[type] = enemy[type] & ~captured;
+    }
+    uint64_t occupancy = ((allPieces(own) | allPieces(enemy)) & ~(1ULL << from) & ~captured) | (1ULL << to);
+    int king = (own[King] & (1ULL << from)) ? to : __builtin_ctzll(own[King]);
+    return !isAttackedBy(king, enemyAfter, opposite(us), occupancy);
+}
+
+//True if the side to move doesn't leave its king attacked by moving from -> to
+static bool keepsKingSafe(const Board& board, int from, int to, bool isEnPassant) {
+    PieceColor us = board.whiteToMove ? white : black;
+    uint64_t own[6], enemy[6];
+    getPieces(board, us, own);
+    getPieces(board, opposite(us), enemy);
+    return leavesKingSafe(own, enemy, us, from, to, isEnPassant ? to + (us == white ? -8 : 8) : to);
+}
+
+//Pieces of the given color and type that pseudo-legally reach the square, castling aside.
+//Pawns capture when capture is set and push otherwise
+static uint64_t piecesReaching(const uint64_t* pieces, PieceColor color, PieceType type, int to, uint64_t occupancy, bool capture) {
+    switch (type) {
+        case Knight: return MoveGenerator::getKnightAttacks(to) & pieces[Knight];
+        case Bishop: return MoveGenerator::getBishopAttacks(to, occupancy) & pieces[Bishop];
+        case Rook: return MoveGenerator::getRookAttacks(to, occupancy) & pieces[Rook];
+        case Queen: return MoveGenerator::getQueenAttacks(to, occupancy) & pieces[Queen];
+        case King: return MoveGenerator::getKingAttacks(to) & pieces[King];
+        case Pawn: {
+            if (capture) {
+                //Our pawns that capture on `to` sit where an enemy pawn on `to` would capture
+                return MoveGenerator::getPawnCaptures(to, opposite(color)) & pieces[Pawn];
+            }
+            int back = color == white ? -8 : 8;
+            int one = to + back;
+            if (one < 0 || one > 63 || (occupancy & (1ULL << to))) {
+                return 0;
+            }
+            if (pieces[Pawn] & (1ULL << one)) {
+                return 1ULL << one;
+            }
+            bool doublePushRank = (to / 8) == (color == white ? 3 : 4);
+            if (doublePushRank && !(occupancy & (1ULL << one))) {
+                return pieces[Pawn] & (1ULL << (one + back));
+            }
+            return 0;
+        }
+        default: return 0;
+    }
+}
+
+//Pieces of the side to move and of the given type that pseudo-legally reach the square, castling aside
+static uint64_t sourcesTo(const Board& board, PieceType type, int to) {
+    PieceColor us = board.whiteToMove ? white : black;
+    uint64_t own = board.getCombinedBoard(us);
+    uint64_t occupancy = own | board.getCombinedBoard(opposite(us));
+    if (own & (1ULL << to)) {
+        return 0;
+    }
+    uint64_t pieces[6];
+    getPieces(board, us, pieces);
+    bool capture = (occupancy & (1ULL << to)) || to == board.enPassantSquare;
+    return piecesReaching(pieces, us, type, to, occupancy, capture);
+}
+
+static bool castlingMove(const Board& board, bool kingside, Move& move) {
+    PieceColor us = board.whiteToMove ? white : black;
+    int kingFrom = us == white ? 4 : 60;
+    int right = us == white ? (kingside ? 1 : 2) : (kingside ? 4 : 8);
+    int rookFrom = kingside ? kingFrom + 3 : kingFrom - 4;
+    uint64_t pieces[6], enemy[6];
+    getPieces(board, us, pieces);
+    getPieces(board, opposite(us), enemy);
+    if (!(board.castlingRights & right) || !(pieces[King] & (1ULL << kingFrom)) || !(pieces[Rook] & (1ULL << rookFrom))) {
+        return false;
+    }
+
+    uint64_t occupancy = board.getCombinedBoard(white) | board.getCombinedBoard(black);
+    uint64_t between = (kingside ? 0x60ULL : 0x0EULL) << (us == white ? 0 : 56);
+    if (occupancy & between) {
+        return false;
+    }
+    //The king may not castle out of, through or into check
+    int step = kingside ? 1 : -1;
+    for (int square = kingFrom; square != kingFrom + 3 * step; square += step) {
+        if (isAttackedBy(square, enemy, opposite(us), occupancy)) {
+            return false;
+        }
+    }
+    move = Move(King, us, kingFrom, kingFrom + 2 * step);
+    return true;
+}
+
+//Validates the remaining rules for a move whose piece is known to reach `to`, and builds it
+static bool finishMove(const Board& board, int from, int to, PieceType type, PieceType promotion, Move& move) {
+    PieceColor us = board.whiteToMove ? white : black;
+    bool lastRank = (to / 8) == (us == white ? 7 : 0);
+    if ((promotion != None) != (type == Pawn && lastRank)) {
+        return false;
+    }
+    bool isEnPassant = type == Pawn && to == board.enPassantSquare;
+    if (!keepsKingSafe(board, from, to, isEnPassant)) {
+        return false;
+    }
+    move = Move(type, us, from, to, promotion, board.getPieceTypeAtBit(to).first, isEnPassant);
+    return true;
+}
+
+bool parseMove(const Board& board, std::string_view text, Move& move) {
+    while (!text.empty() && (text.back() == '+' || text.back() == '#' || text.back() == '!' || text.back() == '?')) {
+        text.remove_suffix(1);
+    }
+    if (text == "O-O" || text == "0-0") {
+        return castlingMove(board, true, move);
+    }
+    if (text == "O-O-O" || text == "0-0-0") {
+        return castlingMove(board, false, move);
+    }
+
+    //Coordinate notation
+    if ((text.size() == 4 || text.size() == 5) && isFile(text[0]) && isRank(text[1]) && isFile(text[2]) && isRank(text[3])) {
+        int from = (text[0] - 'a') + 8 * (text[1] - '1');
+        int to = (text[2] - 'a') + 8 * (text[3] - '1');
+        PieceType promotion = text.size() == 5 ? pieceFromLetter(char(std::toupper((unsigned char)text[4]))) : None;
+        if (text.size() == 5 && (promotion == None || promotion == King)) {
+            return false;
+        }
+        std::pair<PieceType, PieceColor> piece = board.getPieceTypeAtBit(from);
+        if (piece.first == None || piece.second != (board.whiteToMove ? white : black)) {
+            return false;
+        }
+        if (piece.first == King && std::abs(to - from) == 2) {
+            return castlingMove(board, to > from, move) && move.to == to;
+        }
+        if (!(sourcesTo(board, piece.first, to) & (1ULL << from))) {
+            return false;
+        }
+        return finishMove(board, from, to, piece.first, promotion, move);
+    }
+
+    //SAN, read from the back: promotion, destination, then piece and disambiguation from the front
+    PieceType promotion = None;
+    if (text.size() >= 2 && text[text.size() - 2] == '=') {
+        promotion = pieceFromLetter(text.back());
+        if (promotion == None || promotion == King) return false;
+        text.remove_suffix(2);
+    }
+    else if (text.size() >= 3 && isRank(text[text.size() - 2]) && pieceFromLetter(text.back()) != None) {
+        promotion = pieceFromLetter(text.back());
+        if (promotion == King) return false;
+        text.remove_suffix(1);
+    }
+    if (text.size() < 2 || !isFile(text[text.size() - 2]) || !isRank(text.back())) {
+        return false;
+    }
+    int to = (text[text.size() - 2] - 'a') + 8 * (text.back() - '1');
+    text.remove_suffix(2);
+
+    PieceType type = Pawn;
+    if (!text.empty() && pieceFromLetter(text[0]) != None) {
+        type = pieceFromLetter(text[0]);
+        text.remove_prefix(1);
+    }
+    uint64_t sources = sourcesTo(board, type, to);
+    bool marksCapture = false, hasFile = false;
+    for (char c : text) {
+        if (isFile(c)) { sources &= fileMask(c - 'a'); hasFile = true; }
+        else if (isRank(c)) sources &= rankMask(c - '1');
+        else if (c == 'x' || c == ':') marksCapture = true;
+        else if (c != '-') return false;
+    }
+
+    //The capture marker has to match the move, and pawns capture only from a named file ("exd5", never "d5")
+    uint64_t occupancy = board.getCombinedBoard(white) | board.getCombinedBoard(black);
+    bool isCapture = (occupancy & (1ULL << to)) || (type == Pawn && to == board.enPassantSquare);
+    if (marksCapture != isCapture || (type == Pawn && isCapture && !hasFile)) {
+        return false;
+    }
+
+    //Exactly one of the candidates may be legal
+    int from = -1;
+    while (sources) {
+        int square = __builtin_ctzll(sources);
+        sources &= sources - 1;
+        if (keepsKingSafe(board, square, to, type == Pawn && to == board.enPassantSquare)) {
+            if (from != -1) return false;
+            from = square;
+        }
+    }
+    return from != -1 && finishMove(board, from, to, type, promotion, move);
+}
+
+//Replays the move on both sides' bitboards, own being the moving side
+static void playMove(const Board& board, const Move& move, uint64_t* own, uint64_t* enemy) {
+    PieceColor us = move.pieceColor;
+    getPieces(board, us, own);
+    getPieces(board, opposite(us), enemy);
+
+    uint64_t captured = 1ULL << (move.isEnPassant ? move.to + (us == white ? -8 : 8) : move.to);
+    for (int type = Pawn; type <= King; type++) {
+        enemy[type] &= ~captured;
+    }
+    own[move.pieceType] &= ~(1ULL << move.from);
+    own[move.promotionPiece != None ? move.promotionPiece : move.pieceType] |= 1ULL << move.to;
+    if (move.pieceType == King && std::abs(move.to - move.from) == 2) {
+        int rookFrom = move.to > move.from ? move.from + 3 : move.from - 4;
+        int rookTo = (move.from + move.to) / 2;
+        own[Rook] = (own[Rook] & ~(1ULL << rookFrom)) | (1ULL << rookTo);
+    }
+}
+
+//Squares strictly between two squares on a line, empty if they don't share one
+static uint64_t squaresBetween(int a, int b) {
+    uint64_t bitA = 1ULL << a, bitB = 1ULL << b;
+    if (MoveGenerator::getRookAttacks(a, 0) & bitB) {
+        return MoveGenerator::getRookAttacks(a, bitB) & MoveGenerator::getRookAttacks(b, bitA);
+    }
+    if (MoveGenerator::getBishopAttacks(a, 0) & bitB) {
+        return MoveGenerator::getBishopAttacks(a, bitB) & MoveGenerator::getBishopAttacks(b, bitA);
+    }
+    return 0;
+}
+
+//Whether the side in check has any legal move: a king step, or against a single checker a capture
+//or a block. Castling is never legal in check
+static bool hasCheckEvasion(const uint64_t* own, const uint64_t* enemy, PieceColor us, int enPassantSquare) {
+    uint64_t ownPieces = allPieces(own);
+    uint64_t occupancy = ownPieces | allPieces(enemy);
+    int king = __builtin_ctzll(own[King]);
+
+    uint64_t steps = MoveGenerator::getKingAttacks(king) & ~ownPieces;
+    while (steps) {
+        int to = __builtin_ctzll(steps);
+        steps &= steps - 1;
+        if (leavesKingSafe(own, enemy, us, king, to, to)) {
+            return true;
+        }
+    }
+
+    uint64_t checkers = attackersOf(king, enemy, opposite(us), occupancy);
+    if (checkers & (checkers - 1)) {
+        return false;
+    }
+    int checker = __builtin_ctzll(checkers);
+    uint64_t targets = checkers | squaresBetween(king, checker);
+    while (targets) {
+        int to = __builtin_ctzll(targets);
+        targets &= targets - 1;
+        for (int type = Pawn; type < King; type++) {
+            uint64_t sources = piecesReaching(own, us, PieceType(type), to, occupancy, to == checker);
+            while (sources) {
+                int from = __builtin_ctzll(sources);
+                sources &= sources - 1;
+                if (leavesKingSafe(own, enemy, us, from, to, to)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    //A pawn that just gave check with a double push can also be taken en passant
+    int pushedPawn = enPassantSquare + (us == white ? -8 : 8);
+    if (enPassantSquare != -1 && checker == pushedPawn) {
+        uint64_t sources = MoveGenerator::getPawnCaptures(enPassantSquare, opposite(us)) & own[Pawn];
+        while (sources) {
+            int from = __builtin_ctzll(sources);
+            sources &= sources - 1;
+            if (leavesKingSafe(own, enemy, us, from, enPassantSquare, pushedPawn)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static int writeSquare(int square, char* out) {
+    out[0] = char('a' + square % 8);
+    out[1] = char('1' + square / 8);
+    return 2;
+}
+
+int formatSAN(const Board& board, const Move& move, char* out) {
+    int n = 0;
+    if (move.pieceType == King && std::abs(move.to - move.from) == 2) {
+        const char* castle = move.to > move.from ? "O-O" : "O-O-O";
+        while (*castle) out[n++] = *castle++;
+    }
+    else {
+        if (move.pieceType != Pawn) {
+            out[n++] = PIECE_LETTERS[move.pieceType];
+
+            //Other legal pieces of the same type reaching the square, the file is preferred to tell them apart
+            uint64_t others = sourcesTo(board, move.pieceType, move.to) & ~(1ULL << move.from);
+            uint64_t ambiguous = 0;
+            while (others) {
+                int square = __builtin_ctzll(others);
+                others &= others - 1;
+                if (keepsKingSafe(board, square, move.to, false)) {
+                    ambiguous |= 1ULL << square;
+                }
+            }
+            if (ambiguous) {
+                bool sharesFile = ambiguous & fileMask(move.from % 8);
+                bool sharesRank = ambiguous & rankMask(move.from / 8);
+                if (!sharesFile || sharesRank) out[n++] = char('a' + move.from % 8);
+                if (sharesFile) out[n++] = char('1' + move.from / 8);
+            }
+        }
+        if (move.pieceEatenType != None || move.isEnPassant) {
+            if (move.pieceType == Pawn) out[n++] = char('a' + move.from % 8);
+            out[n++] = 'x';
+        }
+        n += writeSquare(move.to, out + n);
+        if (move.promotionPiece != None) {
+            out[n++] = '=';
+            out[n++] = PIECE_LETTERS[move.promotionPiece];
+        }
+    }
+
+    uint64_t own[6], enemy[6];
+    playMove(board, move, own, enemy);
+    PieceColor them = opposite(move.pieceColor);
+    int theirKing = __builtin_ctzll(enemy[King]);
+    if (isAttackedBy(theirKing, own, move.pieceColor, allPieces(own) | allPieces(enemy))) {
+        bool doublePush = move.pieceType == Pawn && std::abs(move.to - move.from) == 16;
+        int enPassantSquare = doublePush ? (move.from + move.to) / 2 : -1;
+        out[n++] = hasCheckEvasion(enemy, own, them, enPassantSquare) ? '+' : '#';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+int formatUCI(const Move& move, char* out) {
+    int n = writeSquare(move.from, out);
+    n += writeSquare(move.to, out + n);
+    if (move.promotionPiece != None) {
+        out[n++] = char(std::tolower((unsigned char)PIECE_LETTERS[move.promotionPiece]));
+    }
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,21 @@
+#include "Board.h"
+#include "Move.h"
+#include <string_view>
+
+#pragma once
+
+//Move notation without move generation, board copies or allocations.
+//Candidate pieces come from the attack tables and legality is checked with bitboards
+
+//Enough for the longest SAN ("Qa1xb2+", "exd8=Q#") or UCI move plus the terminator
+constexpr int NOTATION_BUFFER_SIZE = 16;
+
+//Parses SAN ("Nbd7", "exd5", "e8=Q+", "O-O") or coordinate notation ("e2e4", "e7e8q").
+//Returns false unless the text names exactly one legal move
+bool parseMove(const Board& board, std::string_view text, Move& move);
+
+//Writes the SAN of a legal move into out, check and mate suffixes included. Returns the length
+int formatSAN(const Board& board, const Move& move, char* out);
+
+//Writes coordinate notation ("e2e4", "e7e8q") into out. Returns the length
+int formatUCI(const Move& move, char* out);
@@ -0,0 +1,148 @@
+#include "OpeningBook.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+OpeningBook::~OpeningBook(){
+    close();
+}
+
+bool OpeningBook::open(const std::string& path){
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE){
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= LONGLONG(sizeof(BookHeader))){
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (data == nullptr){
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    view = data;
+    viewSize = size_t(fileSize.QuadPart);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0){
+        return false;
+    }
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && size_t(info.st_size) >= sizeof(BookHeader)){
+        data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    //The mapping keeps the file alive on its own
+    ::close(file);
+    if (data == MAP_FAILED){
+        return false;
+    }
+    view = data;
+    viewSize = size_t(info.st_size);
+#endif
+
+    //Reject anything that isn't exactly a header plus the entries it announces, or that was hashed with other keys
+    BookHeader header;
+    std::memcpy(&header, view, sizeof(header));
+    Board start = Board();
+    start.setStartingPosition();
+    if (std::memcmp(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0
+        || viewSize != sizeof(BookHeader) + size_t(header.entryCount) * sizeof(BookEntry)
+        || header.startKey != start.zobristHash){
+        close();
+        return false;
+    }
+    entries = reinterpret_cast<const BookEntry*>(static_cast<const char*>(view) + sizeof(BookHeader));
+    count = header.entryCount;
+    return true;
+}
+
+void OpeningBook::close(){
+    if (view != nullptr){
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(view, viewSize);
+#endif
+    }
+    view = nullptr;
+    viewSize = 0;
+    entries = nullptr;
+    count = 0;
+}
+
+std::pair<const BookEntry*, const BookEntry*> OpeningBook::find(uint64_t key) const{
+    const BookEntry* first = std::lower_bound(entries, entries + count, key,
+        [](const BookEntry& entry, uint64_t key){ return entry.key < key; });
+    const BookEntry* last = first;
+    while (last != entries + count && last->key == key){
+        last++;
+    }
+    return {first, last};
+}
+
+const BookEntry* OpeningBook::pick(uint64_t key, std::mt19937_64& rng, double variety) const{
+    auto [first, last] = find(key);
+    if (first == last){
+        return nullptr;
+    }
+
+    const BookEntry* best = first;
+    for (const BookEntry* entry = first; entry != last; entry++){
+        if (double(entry->weight) * entry->score > double(best->weight) * best->score){
+            best = entry;
+        }
+    }
+    if (variety <= 0.0){
+        return best;
+    }
+
+    //Relative to the best move, so the powers can't overflow
+    double bestValue = std::max(double(best->weight) * best->score, 1.0);
+    double odds[MAX_MOVES];
+    size_t count = std::min<size_t>(last - first, MAX_MOVES);
+    for (size_t i = 0; i < count; i++){
+        odds[i] = std::pow(std::max(double(first[i].weight) * first[i].score, 1.0) / bestValue, 1.0 / variety);
+    }
+    std::discrete_distribution<size_t> distribution(odds, odds + count);
+    return first + distribution(rng);
+}
+
+Move decodeBookMove(const Board& board, uint16_t packed){
+    int from = packed & 63;
+    int to = (packed >> 6) & 63;
+    int promotion = (packed >> 12) & 7;
+    PieceColor toMove = board.whiteToMove ? white : black;
+
+    std::pair<PieceType, PieceColor> piece = board.getPieceTypeAtBit(from);
+    std::pair<PieceType, PieceColor> target = board.getPieceTypeAtBit(to);
+    if (piece.first == None || piece.second != toMove || (target.first != None && target.second == toMove)
+        || target.first == King || promotion > Queen || (promotion != 0) != (piece.first == Pawn && (to < 8 || to >= 56))){
+        return Move();
+    }
+
+    bool isEnPassant = piece.first == Pawn && to == board.enPassantSquare;
+    return Move(piece.first, toMove, from, to, promotion == 0 ? None : PieceType(promotion), target.first, isEnPassant);
+}
@@ -0,0 +1,66 @@
+#include "Board.h"
+#include "Move.h"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+
+#pragma once
+
+//Binary opening book, built offline by the book_builder tool and memory mapped at startup.
+//Layout: a BookHeader followed by BookEntry records sorted by key, all little endian.
+//Similar to Polyglot, but keyed by Board::zobristHash instead of the Polyglot keys
+struct BookHeader {
+    char magic[4];          // "CBK2"
+    uint32_t entryCount;
+    uint64_t startKey;      // zobristHash of the starting position, rejects books built with other keys
+};
+
+struct BookEntry {
+    uint64_t key;           // zobristHash of the position
+    uint16_t move;          // Move::pack()
+    uint16_t weight;        // how often the move was played, scaled to fit within the position
+    uint16_t score;         // average result for the side playing the move, 0 = always lost, 65535 = always won
+    uint16_t reserved;
+};
+
+static_assert(sizeof(BookHeader) == 16 && sizeof(BookEntry) == 16, "book records must stay 16 bytes");
+
+constexpr char BOOK_MAGIC[4] = {'C', 'B', 'K', '2'};
+
+class OpeningBook {
+    public:
+        OpeningBook() = default;
+        ~OpeningBook();
+        OpeningBook(const OpeningBook&) = delete;
+        OpeningBook& operator=(const OpeningBook&) = delete;
+
+        //Maps the file read only, returns false if it is missing or not a valid book
+        bool open(const std::string& path);
+        void close();
+        bool isOpen() const { return entries != nullptr; }
+        size_t size() const { return count; }
+
+        //All entries of a position, empty range if the position isn't in the book
+        std::pair<const BookEntry*, const BookEntry*> find(uint64_t key) const;
+
+        //Picks one of the position's moves, nullptr if it isn't in the book.
+        //variety 0 always plays the move with the best popularity * score, 1 samples in proportion to it,
+        //and larger values flatten the odds towards a uniform pick
+        const BookEntry* pick(uint64_t key, std::mt19937_64& rng, double variety) const;
+
+    private:
+        const BookEntry* entries = nullptr;
+        size_t count = 0;
+        void* view = nullptr;
+        size_t viewSize = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+};
+
+//Rebuilds a full Move from its packed form using the pieces on the board, without generating moves.
+//Returns Move() (from == -1) if the packed move doesn't fit the position, e.g. after a hash collision
+Move decodeBookMove(const Board& board, uint16_t packed);
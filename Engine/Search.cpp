@@ -7,331 +7,69 @@
 #include <iostream>
 #include "algorithm"
 #include <fstream>
-#include "csv.hpp"
-#include "MoveTree.h"
 #include <chrono>
+#include <filesystem>
+#include <future>
 using namespace std::chrono_literals;
 
-Move parseAlgebraic(std::string notation, Board board) {
-    std::string originalNotation = notation;
-    // Remove move numbers (e.g., "1.e4") and check/checkmate symbols
-    while (!notation.empty() && (isdigit(notation[0]) || notation[0] == '.'))
-        notation = notation.substr(1);
-    if (!notation.empty() && (notation.back() == '+' || notation.back() == '#'))
-        notation.pop_back();
-
-    // Generate all legal moves for current position
-    MoveGenerator gen(board, true);
-    int moveCount = 0;
-    gen.generateLegalMoves(moves, moveCount, 0);
-
-    // Handle castling
-    if (notation == "O-O" || notation == "0-0") {
-        for (int i = 0; i < moveCount; i++) {
-            Move& m = moves[0][i];
-            if (m.pieceType == King && abs(m.to - m.from) == 2) return m;
-        }
-        
-        throw std::runtime_error("No matching kingside castle move found");
-    }
-    if (notation == "O-O-O" || notation == "0-0-0") {
-        for (int i = 0; i < moveCount; i++) {
-            Move& m = moves[0][i];
-            if (m.pieceType == King && abs(m.to - m.from) == 2) return m;
-        }
-        throw std::runtime_error("No matching queenside castle move found");
-    }
-
-    // Remove capture symbol
-    notation.erase(std::remove(notation.begin(), notation.end(), 'x'), notation.end());
-
-    // Extract promotion if present (e.g., e8=Q)
-    PieceType promotion = None;
-    size_t eqPos = notation.find('=');
-    if (eqPos != std::string::npos) {
-        char promChar = notation[eqPos + 1];
-        switch (promChar) {
-            case 'Q': promotion = Queen; break;
-            case 'R': promotion = Rook; break;
-            case 'B': promotion = Bishop; break;
-            case 'N': promotion = Knight; break;
-            default: promotion = None;
-        }
-        notation = notation.substr(0, eqPos); // remove promotion part
-    }
-
-    // Destination square: last 2 chars
-    if (notation.size() < 2)
-        throw std::runtime_error("Invalid SAN: " + notation);
-    std::string destSquare = notation.substr(notation.size() - 2);
-    int dest = Move::stringToSquare(destSquare);
-    notation = notation.substr(0, notation.size() - 2); // remaining part
-
-    // Determine moving piece
-    PieceType piece = Pawn;
-    if (!notation.empty() && isupper(notation[0])) {
-        switch (notation[0]) {
-            case 'K': piece = King; break;
-            case 'Q': piece = Queen; break;
-            case 'R': piece = Rook; break;
-            case 'B': piece = Bishop; break;
-            case 'N': piece = Knight; break;
-        }
-        notation = notation.substr(1); // remove piece char
-    }
-
-    // Disambiguation: file or rank
-    char disambFile = 0;
-    char disambRank = 0;
-    if (!notation.empty()) {
-        if (notation.size() == 2) {
-            disambFile = notation[0];
-            disambRank = notation[1];
-        } else if (isdigit(notation[0])) {
-            disambRank = notation[0];
-        } else {
-            disambFile = notation[0];
-        }
-    }
-
-    // Determine captured piece at destination
-    PieceType eaten = board.getPieceTypeAtBit(dest).first;
-
-    // Search legal moves
-    for (int i = 0; i < moveCount; i++) {
-        Move& m = moves[0][i];
-        if (m.pieceType != piece) continue;
-        if (m.to != dest) continue;
-        if (m.pieceEatenType != eaten) continue;
-        if (promotion != None && m.promotionPiece != promotion) continue;
-
-        std::string fromSq = Move::squareToString(m.from);
-        if (disambFile && fromSq[0] != disambFile) continue;
-        if (disambRank && fromSq[1] != disambRank) continue;
-
-        return m;
-    }
-
-    board.print();
-    for (Move& mv : board.moveHistory){
-        std::cout << mv.toString() << std::endl;
-    }
-    throw std::runtime_error("No matching move found for notation: " + originalNotation);
-}
-
-std::string parseAlgebraic(Move mv, Board board){
-    // Handle castling first
-    if (mv.pieceType == King && std::abs(mv.to - mv.from) == 2) {
-        int fileDiff = (mv.to > mv.from) ? 1 : -1;
-        return (fileDiff > 0) ? "O-O" : "O-O-O";
-    }
-
-    std::string notation;
-
-    // Piece letter (pawns have none)
-    if (mv.pieceType != Pawn) {
-        switch (mv.pieceType) {
-            case Knight: notation += 'N'; break;
-            case Bishop: notation += 'B'; break;
-            case Rook:   notation += 'R'; break;
-            case Queen:  notation += 'Q'; break;
-            case King:   notation += 'K'; break;
-            default: break;
-        }
-    }
-
-    // Generate all legal moves to detect disambiguation
-    MoveGenerator gen(board, true);
-    int moveCount = 0;
-    gen.generateLegalMoves(moves, moveCount, 0);
-
-    std::string fromStr = Move::squareToString(mv.from);
-    std::string toStr   = Move::squareToString(mv.to);
-
-    bool needsFile = false;
-    bool needsRank = false;
-
-    // Check if another piece of same type can reach same square
-    for (int i = 0; i < moveCount; i++) {
-        const Move& m2 = moves[0][i];
-        if (m2.to == mv.to && m2.pieceType == mv.pieceType && m2.from != mv.from) {
-            std::string otherFrom = Move::squareToString(m2.from);
-            if (otherFrom[0] == fromStr[0])
-                needsRank = true;
-            if (otherFrom[1] == fromStr[1])
-                needsFile = true;
-            else {
-                needsFile = true; // default to file disambiguation
-            }
-        }
-    }
-
-    // Disambiguation if needed
-    if (needsFile) notation += fromStr[0];
-    if (needsRank) notation += fromStr[1];
-
-    // Capture handling
-    if (mv.pieceEatenType != None) {
-        if (mv.pieceType == Pawn && !needsFile) {
-            // Pawn captures need file of origin
-            notation += fromStr[0];
-        }
-        notation += 'x';
-    }
-
-    // Destination square
-    notation += toStr;
-
-    // Promotion
-    if (mv.promotionPiece != None) {
-        notation += '=';
-        switch (mv.promotionPiece) {
-            case Queen:  notation += 'Q'; break;
-            case Rook:   notation += 'R'; break;
-            case Bishop: notation += 'B'; break;
-            case Knight: notation += 'N'; break;
-            default: break;
-        }
-    }
-
-    // Optional: detect if move gives check or checkmate
-    // (requires making the move on a copy of the board)
-    Board temp = board;
-    temp.makeMove(mv);
-    MoveGenerator after(temp, true);
-    int nextMoveCount = 0;
-    after.generateLegalMoves(moves, nextMoveCount, 0);
-    bool kingInCheck = gen.isSquareAttacked(board.getKingPosition(board.whiteToMove ? white : black),board.whiteToMove ? black : white);
-    if (kingInCheck) {
-        if (nextMoveCount == 0)
-            notation += '#';
-        else
-            notation += '+';
-    }
-
-    return notation;
-}
-
-
 Search::Search(){
     
 }
-MoveTree Search::openingTree = {};
-
 
-std::vector<std::string> parsePythonListString(const std::string& input) {
-    std::vector<std::string> moves;
-
-    // Remove [ and ]
-    size_t start = input.find('[');
-    size_t end = input.rfind(']');
-    if (start == std::string::npos || end == std::string::npos || end <= start)
-        return moves; // empty vector if invalid
-
-    std::string content = input.substr(start + 1, end - start - 1);
-    std::istringstream ss(content);
-    std::string token;
-
-    while (std::getline(ss, token, ',')) {
-        // Trim whitespace
-        token.erase(token.begin(), std::find_if(token.begin(), token.end(), [](unsigned char ch) {
-            return !std::isspace(ch);
-        }));
-        token.erase(std::find_if(token.rbegin(), token.rend(), [](unsigned char ch) {
-            return !std::isspace(ch);
-        }).base(), token.end());
-
-        // Remove surrounding single quotes if present
-        if (!token.empty() && token.front() == '\'') token.erase(0, 1);
-        if (!token.empty() && token.back() == '\'') token.pop_back();
-
-        if (!token.empty()) moves.push_back(token);
-    }
-
-    return moves;
+void Search::newGame(uint64_t seed){
+    bookRng.seed(seed);
 }
-
-
-void Search::initOpeningTreeTXT(){
-    openingTree.root = MoveNode();
-
-    std::ifstream OpeningFile("Games.txt");
-
-    std::string currentOpening;
-    while (getline (OpeningFile, currentOpening)) {
-
-        std::stringstream ss(currentOpening);
-	
-        // Temporary object to store 
-        // the splitted string
-        std::string t;
-    
-        // Delimiter
-        char del = ' ';
-
-        MoveNode* currentMoveNode = &openingTree.root;
-
-
-        // Splitting the str string 
-        // by delimiter
-        int c = 0;
-        while (getline(ss, t, del)){
-            if (c == 8){break;}
-            if (std::find(t.begin(),t.end(),'-') != t.end()){break;}
-
-
-            auto it = std::find_if(currentMoveNode->children.begin(), currentMoveNode->children.end(),
-                                [&](const MoveNode& node){ return node.value == t; });
-
-            if (it == currentMoveNode->children.end()){
-                currentMoveNode->children.push_back(MoveNode(t));
-                currentMoveNode = &currentMoveNode->children.back(); // go deeper
-            } else {
-                currentMoveNode = &(*it);
-            }
-            c++;
-
+OpeningBook Search::openingBook;
+
+//Set once tb_init has returned, until then every probe falls back to plain search
+static std::atomic<bool> tablebasesLoaded{false};
+//Joined on exit, so the process never tears down Fathom halfway through loading
+static std::future<void> tablebaseLoader;
+
+//Reads the WDL files of the smallest endings once, so their first probes hit the OS page cache
+static void warmUpTablebases(const std::string& path, int warmPieces){
+    std::vector<char> buffer(1 << 20);
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(path, error)){
+        std::string name = file.path().filename().string();
+        if (file.path().extension() != ".rtbw"){
+            continue;
+        }
+        //Names like KRPvKR have one letter per piece
+        int pieces = std::count_if(name.begin(), name.end(), [](char c){ return std::isupper((unsigned char)c); });
+        if (pieces > warmPieces){
+            continue;
         }
+        std::ifstream in(file.path(), std::ios::binary);
+        while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0){}
     }
-
 }
 
-void Search::initOpeningTreeCSV(){
-    openingTree.root = MoveNode();
-    
-
-    csv::CSVReader reader("high_elo_opening.csv");
-    
-    std::vector<std::string> moveList;
-    for (auto& row: reader) {
-        Board board = Board();
-        board.setStartingPosition();
-        // Note: Can also use index of column with [] operator
-        moveList = parsePythonListString(row["moves_list"].get());
-        
-
-        MoveNode* currentMoveNode = &openingTree.root;
-
-
-        Move convertNotationToMove;
-        for (std::string move : moveList){
-
-            auto it = std::find_if(currentMoveNode->children.begin(), currentMoveNode->children.end(),
-                                [&](const MoveNode& node){ return node.value == move; });
-
-            if (it == currentMoveNode->children.end()){
-                currentMoveNode->children.push_back(MoveNode(move));
-                currentMoveNode = &currentMoveNode->children.back(); // go deeper
-            } else {
-                currentMoveNode = &(*it);
-            }
+void Search::initTablebasesAsync(const std::string& path, int warmPieces){
+    tablebaseLoader = std::async(std::launch::async, [path, warmPieces](){
+        auto start = std::chrono::steady_clock::now();
+        if (!tb_init(path.c_str()) || TB_LARGEST == 0){
+            std::cout << "No tablebases found in " << path << std::endl;
+            return;
         }
-    }
-    
+        if (warmPieces > 0){
+            warmUpTablebases(path, warmPieces);
+        }
+        tablebasesLoaded.store(true, std::memory_order_release);
+        std::cout << "Tablebases up to " << TB_LARGEST << " pieces ready in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << "ms" << std::endl;
+    });
+}
 
+bool Search::tablebasesReady(){
+    return tablebasesLoaded.load(std::memory_order_acquire);
 }
 
 
+constexpr int DRAW_SCORE = 0;
+//Below any mate score, so a real mate is still preferred over a tablebase win
+constexpr int TB_WIN_SCORE = 50000;
+
 std::chrono::milliseconds MAX_SEARCH_TIME = std::chrono::milliseconds(1000);
 
 int probeResult(const Board& b) {
@@ -351,49 +89,142 @@ int probeResult(const Board& b) {
         b.halfMoveClock, b.castlingRights, b.enPassantSquare == -1 ? 0: b.enPassantSquare, b.whiteToMove
     );
 
-    return wdl; // 0 = loss, 1 = draw, 2 = win
+    return wdl; // TB_LOSS..TB_WIN for the side to move, or TB_RESULT_FAILED
 }
 
-Move Search::findBestMoveEndgame(Board& board, unsigned int score){
-    Move move;
-    move.from = TB_GET_FROM(score);
-    move.to = TB_GET_TO(score);
+//Converts a WDL result for the side to move into a white point of view score and the bound it gives.
+//Wins found with more depth left are closer to the root, so converting sooner scores higher
+static int tbScore(unsigned wdl, bool whiteToMove, int depth, TTFlag& flag) {
+    int score = DRAW_SCORE;
+    flag = EXACT;
+    if (wdl == TB_WIN) {
+        score = TB_WIN_SCORE + depth;
+        flag = LOWERBOUND;
+    }
+    else if (wdl == TB_LOSS) {
+        score = -TB_WIN_SCORE - depth;
+        flag = UPPERBOUND;
+    }
+    //Cursed wins and blessed losses are draws under the fifty move rule
+    if (!whiteToMove) {
+        score = -score;
+        flag = flag == LOWERBOUND ? UPPERBOUND : flag == UPPERBOUND ? LOWERBOUND : EXACT;
+    }
+    return score;
+}
 
-    move.pieceType = board.getPieceTypeAtBit(move.from).first;
-    move.pieceColor = board.getPieceTypeAtBit(move.from).second;
+unsigned Search::probeWDL(const Board& board){
+    unsigned wdl = probeTBCache(board.zobristHash);
+    if (wdl != TBCACHE_MISS){
+        stats.tbCacheHits++;
+        return wdl;
+    }
 
-    move.pieceEatenType = board.getPieceTypeAtBit(move.to).first;
-    move.promotionPiece = static_cast<PieceType>(TB_GET_PROMOTES(score));
-    if(move.promotionPiece == Pawn){move.promotionPiece = None;}
-    move.isEnPassant = TB_GET_EP(score) != 0;
-    return move;
+    stats.tbCacheMisses++;
+    auto start = std::chrono::steady_clock::now();
+    wdl = probeResult(board);
+    stats.tbProbeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (wdl != TB_RESULT_FAILED){
+        storeTBCache(board.zobristHash, wdl);
+    }
+    return wdl;
 }
 
-Move Search::findBestMoveIterative(Board& board){
-    if (board.countPieces() <= 5){
-        std::cout << "Less than 5 pieces" << std::endl;
-        uint64_t white = board.getCombinedBoard(PieceColor::white); // e1 + f2
-        uint64_t black = board.getCombinedBoard(PieceColor::black);                // h1
-        uint64_t kings = board.whiteKing | board.blackKing ;
-        uint64_t queens = board.whiteQueens |board.blackQueens;
-        uint64_t rooks = board.whiteRooks |board.blackRooks;
-        uint64_t bishops = board.whiteBishops | board.blackBishops;
-        uint64_t knights = board.whiteKnights | board.blackKnights;
-        uint64_t pawns = board.whitePawns |board.blackPawns;
-        bool whiteToMove = board.whiteToMove;
-        unsigned int* results;
-        unsigned int wdl = tb_probe_root(
-            white, black, kings, queens, rooks, bishops, knights, pawns,
-            0, 0, 0, false,results
-        );
-        
-
-        if (wdl != TB_RESULT_FAILED){
-
-            return findBestMoveEndgame(board, wdl);
+//Fathom's TB_PROMOTES_* codes
+static const PieceType TB_PROMOTIONS[5] = {None, Queen, Rook, Bishop, Knight};
+
+bool Search::probeRoot(Board& board){
+    //Far too large for the stack, and the root probes aren't thread safe anyway
+    static TbRootMoves results;
+
+    uint64_t white = board.getCombinedBoard(PieceColor::white);
+    uint64_t black = board.getCombinedBoard(PieceColor::black);
+    uint64_t kings = board.whiteKing | board.blackKing;
+    uint64_t queens = board.whiteQueens | board.blackQueens;
+    uint64_t rooks = board.whiteRooks | board.blackRooks;
+    uint64_t bishops = board.whiteBishops | board.blackBishops;
+    uint64_t knights = board.whiteKnights | board.blackKnights;
+    uint64_t pawns = board.whitePawns | board.blackPawns;
+    unsigned ep = board.enPassantSquare == -1 ? 0 : board.enPassantSquare;
+
+    //DTZ ranks keep a won ending won under the fifty move rule, WDL is the fallback when DTZ files are missing
+    bool probed = tb_probe_root_dtz(white, black, kings, queens, rooks, bishops, knights, pawns,
+            board.halfMoveClock, board.castlingRights, ep, board.whiteToMove, board.isRepetition(), true, &results)
+        || tb_probe_root_wdl(white, black, kings, queens, rooks, bishops, knights, pawns,
+            board.halfMoveClock, board.castlingRights, ep, board.whiteToMove, true, &results);
+    if (!probed || results.size == 0){
+        return false;
+    }
+
+    int bestRank = INT_MIN;
+    for (unsigned i = 0; i < results.size; i++){
+        bestRank = std::max(bestRank, int(results.moves[i].tbRank));
+    }
+
+    MoveGenerator gen(board);
+    int moveCount = 0;
+    gen.generateLegalMoves(moves, moveCount, 0);
+    for (unsigned i = 0; i < results.size; i++){
+        if (results.moves[i].tbRank != bestRank){
+            continue;
+        }
+        TbMove tbMove = results.moves[i].move;
+        for (int j = 0; j < moveCount; j++){
+            const Move& move = moves[0][j];
+            if (move.from == int(TB_MOVE_FROM(tbMove)) && move.to == int(TB_MOVE_TO(tbMove))
+                && move.promotionPiece == TB_PROMOTIONS[TB_MOVE_PROMOTES(tbMove)]){
+                tbRootMoves.push_back(move);
+                break;
+            }
         }
     }
+    return !tbRootMoves.empty();
+}
 
+//Prints the counters of the search that just finished
+void Search::reportStats(){
+    stats.finish();
+    if (stats.tbCacheHits + stats.tbCacheMisses > 0 && verbose){
+        std::cout << "TB PROBES: " << stats.tbHits << " used, " << stats.tbCacheHits << " cache hits, " << stats.tbCacheMisses << " misses, "
+            << stats.tbProbeNanos / 1000 / std::max<uint64_t>(stats.tbCacheMisses, 1) << "us per miss" << std::endl;
+    }
+    if (statsOutput != nullptr){
+        *statsOutput << stats.toJSON() << std::endl;
+    }
+}
+
+//One probe by hash, so transpositions into book lines are found too
+bool Search::probeBook(const Board& board, Move& move){
+    if (!openingBook.isOpen()) {
+        return false;
+    }
+    const BookEntry* entry = openingBook.pick(board.zobristHash, bookRng, bookVariety);
+    if (entry == nullptr) {
+        return false;
+    }
+    move = decodeBookMove(board, entry->move);
+    return move.from != -1;
+}
+
+Move Search::findBestMoveIterative(Board& board){
+    //Book moves are played without a search, so they leave no stats behind
+    Move bookMove;
+    if (probeBook(board, bookMove)){
+        return bookMove;
+    }
+    stats.start();
+    tbRootMoves.clear();
+    if (tablebasesReady() && board.countPieces() <= (int)TB_LARGEST && probeRoot(board)){
+        if (verbose){
+            std::cout << "Tablebase root: " << tbRootMoves.size() << " preserving moves" << std::endl;
+        }
+        if (tbRootMoves.size() == 1){
+            Move bestMove = tbRootMoves[0];
+            tbRootMoves.clear();
+            reportStats();
+            return bestMove;
+        }
+    }
 
     clearTT();
 
@@ -402,6 +233,7 @@ Move Search::findBestMoveIterative(Board& board){
     Move bestMove;
     while (true){
         bestMove = findBestMove(board,currentDepth);
+        stats.endIteration(currentDepth, lastScore);
         std::chrono::time_point now = std::chrono::high_resolution_clock::now();
 
         if(std::chrono::duration_cast<std::chrono::milliseconds>(now-start) > MAX_SEARCH_TIME
@@ -411,81 +243,157 @@ Move Search::findBestMoveIterative(Board& board){
         currentDepth++;
     }
     std::cout << "DEPTH ACHIEVED: " << currentDepth << std::endl;
+    reportStats();
+    tbRootMoves.clear();
     return bestMove;
 }
 
 
 Move Search::findBestMove(Board& board, int depth) {
-    MoveNode* currNode = &openingTree.root;
-    bool flag = true;
-    for (Move& mv : board.moveHistory){
-        std::vector<MoveNode>& children = currNode->children;
-        std::vector<std::string> moveChildren = {};
-        for (MoveNode& mv : children){
-            moveChildren.emplace_back(mv.value);
-        }
-
-
-        if (std::find(moveChildren.begin(), moveChildren.end(),parseAlgebraic(mv,board)) != moveChildren.end()){
-            for (MoveNode& child : currNode->children) {
-                if (child.value == parseAlgebraic(mv, board)) {
-                    currNode = &child;
-                    break;
-                }
-            }
-
-        }
-        else{
-            flag = false;
-            break;
-        }
-    }
-    if (flag){
-        
-
-        int randomMove = std::rand() % currNode->children.size();
-        return parseAlgebraic(currNode->children[randomMove].value,board);
-
-        
-    }
     MoveGenerator gen(board);
     int moveCount = 0;
     gen.generateLegalMoves(moves, moveCount, depth);
 
-    int bestScore = INT_MAX;
+    //White maximizes, black minimizes
+    bool maximizing = board.whiteToMove;
+    int bestScore = maximizing ? INT_MIN : INT_MAX;
     Move bestMove;
     for (int i = 0; i < moveCount; i++) {
+        //In a tablebase ending only the moves that keep the best result are searched
+        if (!tbRootMoves.empty() && std::none_of(tbRootMoves.begin(), tbRootMoves.end(),
+                [&](const Move& move){ return move.pack() == moves[depth][i].pack(); })) {
+            continue;
+        }
         board.makeMove(moves[depth][i]);
-        int score = alphaBeta(board, depth - 1, INT_MIN, INT_MAX, true);
+        int score = alphaBeta(board, depth - 1, INT_MIN, INT_MAX, !maximizing);
         board.unmakeMove(moves[depth][i]);
-        if (score < bestScore) {
+        if (stopped) {
+            break;
+        }
+        if (maximizing ? score > bestScore : score < bestScore) {
             bestScore = score;
             bestMove = moves[depth][i];
         }
-        std::cout << moves[depth][i].toString() << " " << score << std::endl;
+        if (verbose) {
+            std::cout << moves[depth][i].toString() << " " << score << std::endl;
+        }
+    }
+    if (verbose) {
+        std::cout << "----------------------" << std::endl;
+    }
+    if (!stopped) {
+        lastScore = bestScore;
     }
-    std::cout << "----------------------" << std::endl;
 
     return bestMove;
 }
 
+Move Search::findBestMoveLimited(Board& board, int maxDepth, uint64_t maxNodes){
+    Move bookMove;
+    if (probeBook(board, bookMove)){
+        return bookMove;
+    }
+    nodeLimit = maxNodes;
+    stats.start();
+    stopped = false;
+
+    Move bestMove;
+    int bestScore = 0;
+    for (int depth = 1; depth <= std::min(maxDepth, MAX_DEPTH - 1); depth++){
+        Move move = findBestMove(board, depth);
+        //An interrupted iteration has not seen every root move, keep the last complete one
+        if (stopped){
+            break;
+        }
+        bestMove = move;
+        bestScore = lastScore;
+        stats.endIteration(depth, lastScore);
+    }
+
+    nodeLimit = 0;
+    stopped = false;
+    if (bestMove.from == -1){
+        bestMove = findBestMove(board, 1);
+        bestScore = lastScore;
+    }
+    lastScore = bestScore;
+    reportStats();
+    return bestMove;
+}
+
 
 int Search::alphaBeta(Board& board, int depth, int alpha, int beta, bool maximizingPlayer) {
+    stats.nodes++;
+    if (nodeLimit != 0 && stats.nodes >= nodeLimit) {
+        stopped = true;
+    }
+    if (stopped) {
+        return 0;
+    }
+
     int alphaOrig = alpha;
+    int betaOrig = beta;
     uint64_t key = board.zobristHash;
 
+    // Path dependent draws come first, the TT has no idea how we got here
+    if (board.isRepetition()) {
+        pathDraws++;
+        return DRAW_SCORE;
+    }
+    if (board.halfMoveClock >= 100) {
+        MoveGenerator gen(board);
+        int moveCount = 0;
+        gen.generateLegalMoves(moves, moveCount, depth);
+        PieceColor toMove = board.whiteToMove ? white : black;
+        if (moveCount == 0 && gen.isSquareAttacked(board.getKingPosition(toMove), toMove == white ? black : white)) {
+            return maximizingPlayer ? -100000 : 100000;
+        }
+        pathDraws++;
+        return DRAW_SCORE;
+    }
+
     // 1️⃣ TT probe
-    if (auto* entry = probeTT(key)) {
-        if (entry->depth >= depth) {
-            if (entry->flag == EXACT) return entry->score;
-            if (entry->flag == LOWERBOUND && entry->score >= beta) return entry->score;
-            if (entry->flag == UPPERBOUND && entry->score <= alpha) return entry->score;
-            
+    TTEntry entry;
+    stats.ttProbes++;
+    if (probeTT(key, entry)) {
+        stats.ttHits++;
+        if (entry.depth >= depth) {
+            if (entry.flag == EXACT
+                || (entry.flag == LOWERBOUND && entry.score >= beta)
+                || (entry.flag == UPPERBOUND && entry.score <= alpha)) {
+                stats.ttCutoffs++;
+                return entry.score;
+            }
         }
     }
-    
-    
+
+    int tbLower = INT_MIN, tbUpper = INT_MAX;
+    //Probe right after a capture or pawn move, which is when the piece count drops into the tablebases.
+    //Fathom's WDL tables assume a fresh fifty move counter and no castling rights
+    if (board.halfMoveClock == 0 && board.castlingRights == 0 && tablebasesReady() && board.countPieces() <= (int)TB_LARGEST) {
+        unsigned wdl = probeWDL(board);
+        if (wdl != TB_RESULT_FAILED) {
+            stats.tbHits++;
+            TTFlag flag;
+            int score = tbScore(wdl, board.whiteToMove, depth, flag);
+            if (flag == EXACT || (flag == LOWERBOUND && score >= beta) || (flag == UPPERBOUND && score <= alpha)) {
+                storeTT(key, depth, score, flag, 0);
+                return score;
+            }
+            //A win or loss that doesn't cut still bounds what the search below can return
+            if (flag == LOWERBOUND) {
+                tbLower = score;
+                alpha = std::max(alpha, score);
+            }
+            else {
+                tbUpper = score;
+                beta = std::min(beta, score);
+            }
+        }
+    }
+
     if (depth == 0) {
+        stats.leafNodes++;
         return Evaluator::evaluate(board);
     }
 
@@ -504,7 +412,7 @@ int Search::alphaBeta(Board& board, int depth, int alpha, int beta, bool maximiz
     }
 
     Move bestMove;
-    if (auto* entry = probeTT(key)) bestMove = entry->bestMove;
+    uint64_t drawsBefore = pathDraws;
 
     std::sort(moves[depth], moves[depth] + moveCount, [](const Move& a, const Move& b) {
         int scoreA = 0, scoreB = 0;
@@ -523,19 +431,32 @@ int Search::alphaBeta(Board& board, int depth, int alpha, int beta, bool maximiz
             int childValue = alphaBeta(board, depth - 1, alpha, beta, false);
 
             board.unmakeMove(moves[depth][i]);
+            if (stopped) {
+                return 0;
+            }
 
-            value = std::max(value, childValue);
+            if (childValue > value) {
+                value = childValue;
+                bestMove = moves[depth][i];
+            }
             alpha = std::max(alpha, value);
             if (alpha >= beta) {
+                stats.betaCutoffs++;
+                stats.firstMoveCutoffs += i == 0;
                 break; // beta cutoff
             }
         }
+        value = std::min(std::max(value, tbLower), tbUpper);
+
         TTFlag flag;
         if (value <= alphaOrig) flag = UPPERBOUND;
-        else if (value >= beta) flag = LOWERBOUND;
+        else if (value >= betaOrig) flag = LOWERBOUND;
         else flag = EXACT;
 
-        storeTT(key, depth, value, flag, bestMove);
+        // A draw score that came from a repetition below us only holds on this path
+        if (value != DRAW_SCORE || pathDraws == drawsBefore) {
+            storeTT(key, depth, value, flag, bestMove.pack());
+        }
         return value;
     } else {
         int value = INT_MAX;
@@ -545,20 +466,33 @@ int Search::alphaBeta(Board& board, int depth, int alpha, int beta, bool maximiz
             int childValue = alphaBeta(board, depth - 1, alpha, beta, true);
 
             board.unmakeMove(moves[depth][i]);
+            if (stopped) {
+                return 0;
+            }
 
-            value = std::min(value, childValue);
+            if (childValue < value) {
+                value = childValue;
+                bestMove = moves[depth][i];
+            }
             beta = std::min(beta, value);
             if (beta <= alpha) {
+                stats.betaCutoffs++;
+                stats.firstMoveCutoffs += i == 0;
                 break; // alpha cutoff
             }
         }
 
+        value = std::min(std::max(value, tbLower), tbUpper);
+
         TTFlag flag;
         if (value <= alphaOrig) flag = UPPERBOUND;
-        else if (value >= beta) flag = LOWERBOUND;
+        else if (value >= betaOrig) flag = LOWERBOUND;
         else flag = EXACT;
 
-        storeTT(key, depth, value, flag, bestMove);
+        // A draw score that came from a repetition below us only holds on this path
+        if (value != DRAW_SCORE || pathDraws == drawsBefore) {
+            storeTT(key, depth, value, flag, bestMove.pack());
+        }
         return value;
     }
 }
\ No newline at end of file
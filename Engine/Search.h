@@ -1,28 +1,53 @@
 #include "Move.h"
 #include "Board.h"
-#include "MoveTree.h"
+#include "OpeningBook.h"
 #include "../Engine/MoveGenerator.h"
 #include "tbprobe.h"
+#include "TBCache.h"
+#include "SearchStats.h"
+#include <ostream>
 
 #pragma once
 
-Move parseAlgebraic(std::string notation, Board board);
-
-std::string parseAlgebraic(Move mv, Board board);
-
 class Search{
 	public: 
-		static MoveTree openingTree;
-		static void initOpeningTreeCSV();
-		static void initOpeningTreeTXT();
+		static OpeningBook openingBook;
+		//Loads the tablebases on a background thread and optionally pre-reads the WDL files of up to warmPieces pieces.
+		//Searches started before it finishes simply don't probe
+		static void initTablebasesAsync(const std::string& path, int warmPieces = 4);
+		static bool tablebasesReady();
 		Search();
 
+		bool verbose = true;       // print every root move and the depth reached
+		uint64_t nodeLimit = 0;    // stop the search after this many nodes, 0 for no limit
+		SearchStats stats;         // counters of the last search
+		std::ostream* statsOutput = nullptr; // gets stats.toJSON() as one line after every search
+		int lastScore = 0;         // score of the last best move, white's point of view
+		double bookVariety = 1.0;  // see OpeningBook::pick, 0 always plays the strongest book move
+
+		//Reseeds the book move choice, the same seed replays the same opening
+		void newGame(uint64_t seed);
+
 		Move findBestMove(Board& board, int depth);
 		Move findBestMoveIterative(Board& board);
-
-		Move findBestMoveEndgame(Board& board, unsigned int score);
+		//Iterative deepening up to maxDepth, stopping early once maxNodes is spent (0 = no node budget)
+		Move findBestMoveLimited(Board& board, int maxDepth, uint64_t maxNodes);
 
 	private:
+		bool stopped = false;
+		std::mt19937_64 bookRng;
+		//Root moves that keep the tablebase result, empty when the root isn't in the tablebases
+		std::vector<Move> tbRootMoves;
+		//Repetition and fifty move draws seen so far, their scores depend on the path and must not be cached
+		uint64_t pathDraws = 0;
+
+		//Picks a book move for the root, false when the position isn't in the book
+		bool probeBook(const Board& board, Move& move);
+		//Fills tbRootMoves from Fathom's root probe, false if the root can't be probed
+		bool probeRoot(Board& board);
+		//probeResult behind the WDL cache, with the counters above updated
+		unsigned probeWDL(const Board& board);
 		int alphaBeta(Board& board, int depth, int alpha, int beta, bool maximizingPlayer);
+		void reportStats();
 
 };
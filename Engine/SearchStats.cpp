@@ -0,0 +1,64 @@
+#include "SearchStats.h"
+#include <cmath>
+#include <sstream>
+
+void SearchStats::start(){
+    *this = SearchStats();
+    startTime = std::chrono::steady_clock::now();
+    iterationStart = startTime;
+}
+
+void SearchStats::endIteration(int depth, int score){
+    auto now = std::chrono::steady_clock::now();
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - iterationStart).count();
+    iterations.push_back({depth, score, nodes - iterationStartNodes, elapsed});
+    iterationStart = now;
+    iterationStartNodes = nodes;
+}
+
+void SearchStats::finish(){
+    micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+double SearchStats::firstMoveCutoffRate() const{
+    return betaCutoffs == 0 ? 0.0 : double(firstMoveCutoffs) / betaCutoffs;
+}
+
+double SearchStats::effectiveBranchingFactor() const{
+    if (iterations.size() >= 2 && iterations[iterations.size() - 2].nodes > 0){
+        return double(iterations.back().nodes) / iterations[iterations.size() - 2].nodes;
+    }
+    //A single iteration only tells us the average width
+    if (iterations.size() == 1 && iterations[0].depth > 0){
+        return std::pow(double(iterations[0].nodes), 1.0 / iterations[0].depth);
+    }
+    return 0.0;
+}
+
+std::string SearchStats::toJSON() const{
+    std::ostringstream out;
+    out.precision(4);
+    out << "{\"depth\":" << depth()
+        << ",\"nodes\":" << nodes
+        << ",\"leafNodes\":" << leafNodes
+        << ",\"micros\":" << micros
+        << ",\"nps\":" << (micros == 0 ? 0 : nodes * 1000000 / micros)
+        << ",\"ttProbes\":" << ttProbes
+        << ",\"ttHits\":" << ttHits
+        << ",\"ttCutoffs\":" << ttCutoffs
+        << ",\"betaCutoffs\":" << betaCutoffs
+        << ",\"firstMoveCutoffRate\":" << firstMoveCutoffRate()
+        << ",\"ebf\":" << effectiveBranchingFactor()
+        << ",\"tbHits\":" << tbHits
+        << ",\"tbCacheHits\":" << tbCacheHits
+        << ",\"tbCacheMisses\":" << tbCacheMisses
+        << ",\"tbProbeMicros\":" << tbProbeNanos / 1000
+        << ",\"iterations\":[";
+    for (size_t i = 0; i < iterations.size(); i++){
+        const IterationStats& iteration = iterations[i];
+        out << (i == 0 ? "" : ",") << "{\"depth\":" << iteration.depth << ",\"score\":" << iteration.score
+            << ",\"nodes\":" << iteration.nodes << ",\"micros\":" << iteration.micros << "}";
+    }
+    out << "]}";
+    return out.str();
+}
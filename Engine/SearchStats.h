@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#pragma once
+
+//One completed iteration of iterative deepening
+struct IterationStats {
+    int depth;
+    int score;          // white's point of view
+    uint64_t nodes;     // nodes of this iteration alone
+    uint64_t micros;    // time of this iteration alone
+};
+
+//Counters of a single search, reset when it starts. Read them through Search::stats,
+//or get the whole thing as one JSON line from toJSON()
+struct SearchStats {
+    uint64_t nodes = 0;
+    uint64_t leafNodes = 0;         // static evaluations at depth 0, the search has no quiescence stage
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;            // probes that found the position
+    uint64_t ttCutoffs = 0;         // hits deep enough to return right away
+    uint64_t betaCutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;  // cutoffs caused by the first move searched, a measure of move ordering
+    uint64_t tbHits = 0;            // successful tablebase probes inside the tree
+    uint64_t tbCacheHits = 0;       // probes answered by the WDL cache
+    uint64_t tbCacheMisses = 0;     // probes that went to Fathom's files
+    uint64_t tbProbeNanos = 0;      // time spent inside Fathom on cache misses
+    uint64_t micros = 0;            // whole search
+    std::vector<IterationStats> iterations;
+
+    void start();
+    //Records the iteration that just finished, counting from the previous one
+    void endIteration(int depth, int score);
+    void finish();
+
+    double firstMoveCutoffRate() const;
+    //Growth of the tree from the second to last iteration to the last one
+    double effectiveBranchingFactor() const;
+    int depth() const { return iterations.empty() ? 0 : iterations.back().depth; }
+
+    //Single line, no trailing newline
+    std::string toJSON() const;
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point iterationStart;
+    uint64_t iterationStartNodes = 0;
+};
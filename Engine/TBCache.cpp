@@ -0,0 +1,3 @@
+#include "TBCache.h"
+
+std::atomic<uint64_t> TBCache[TBCACHE_SIZE];
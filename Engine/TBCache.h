@@ -0,0 +1,27 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#pragma once
+
+//Small cache of tablebase WDL results in front of Fathom, keyed by zobristHash.
+//Each slot is a single atomic word, the key with its low bits replaced by the result + 1,
+//so concurrent searches can share it without locking or torn reads
+constexpr size_t TBCACHE_SIZE = 1 << 16; // 64K entries, 512KB
+constexpr uint64_t TBCACHE_VALUE_MASK = 7;
+constexpr unsigned TBCACHE_MISS = 0xFFFFFFFF; // same as TB_RESULT_FAILED
+
+extern std::atomic<uint64_t> TBCache[TBCACHE_SIZE];
+
+inline unsigned probeTBCache(uint64_t key) {
+    uint64_t entry = TBCache[key & (TBCACHE_SIZE - 1)].load(std::memory_order_relaxed);
+    if ((entry & TBCACHE_VALUE_MASK) == 0 || ((entry ^ key) & ~TBCACHE_VALUE_MASK) != 0) {
+        return TBCACHE_MISS;
+    }
+    return unsigned(entry & TBCACHE_VALUE_MASK) - 1;
+}
+
+//Only successful probes are cached, a failure may just mean the tables aren't loaded yet
+inline void storeTBCache(uint64_t key, unsigned wdl) {
+    TBCache[key & (TBCACHE_SIZE - 1)].store((key & ~TBCACHE_VALUE_MASK) | (wdl + 1), std::memory_order_relaxed);
+}
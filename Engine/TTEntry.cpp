@@ -1,4 +1,4 @@
 // TTEntry.cpp or Engine.cpp
 #include "TTEntry.h"
 
-TTEntry TT[TTSIZE];  // actual definition
+TTSlot TT[TTSIZE];  // actual definition
@@ -1,42 +1,67 @@
 #include "Move.h"
+#include "Trace.h"
 #include <bits/stdc++.h>
 
 #pragma once
 
 enum TTFlag { EXACT, LOWERBOUND, UPPERBOUND };
 
+//Unpacked view of a table slot
 struct TTEntry {
-    uint64_t key = 0;      // 64-bit Zobrist key
-    int16_t depth = -1;     // depth of search (signed to allow -1)
-    int16_t score = 0;     // evaluation score
-    TTFlag flag;      // EXACT / ALPHA / BETA
-    Move bestMove;     // 16–32 bits if you pack it efficiently
+    int depth = -1;        // depth of search
+    int score = 0;         // evaluation score
+    TTFlag flag = EXACT;   // EXACT / ALPHA / BETA
+    uint16_t bestMove = 0; // Move::pack() of the best move
+};
+
+//The key is stored xored with the data, so a slot torn by two threads
+//writing at once fails validation instead of returning mixed data
+struct TTSlot {
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> data;
 };
 
 
 constexpr size_t TTSIZE = 1 << 24; // 16M entries
-extern TTEntry TT[TTSIZE];
+extern TTSlot TT[TTSIZE];
 
 
+inline uint64_t packTTData(int depth, int score, TTFlag flag, uint16_t bestMove) {
+    return uint64_t(uint32_t(score))
+        | (uint64_t(uint8_t(depth)) << 32)
+        | (uint64_t(flag) << 40)
+        | (uint64_t(bestMove) << 42)
+        | (1ULL << 63); // marks the slot as used
+}
 
 inline void clearTT(){
-    std::memset(TT, 0, sizeof(TTEntry) * TTSIZE);
+    for (size_t i = 0; i < TTSIZE; i++) {
+        TT[i].key.store(0, std::memory_order_relaxed);
+        TT[i].data.store(0, std::memory_order_relaxed);
+    }
 }
 
-inline TTEntry* probeTT(uint64_t key) {
-    size_t idx = key & (TTSIZE - 1);
-    TTEntry& e = TT[idx];
-    return (e.key == key) ? &e : nullptr;
+inline bool probeTT(uint64_t key, TTEntry& entry) {
+    TRACE_SCOPE(ProbeTT);
+    TTSlot& slot = TT[key & (TTSIZE - 1)];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.key.load(std::memory_order_relaxed) ^ data) != key || data == 0) {
+        return false;
+    }
+    entry.score = int32_t(uint32_t(data));
+    entry.depth = int8_t(data >> 32);
+    entry.flag = TTFlag((data >> 40) & 3);
+    entry.bestMove = uint16_t(data >> 42);
+    return true;
 }
 
-inline void storeTT(uint64_t key, int depth, int score, TTFlag flag, Move bestMove) {
-    size_t idx = key & (TTSIZE - 1);
-    TTEntry& e = TT[idx];
-    if (e.key == 0 || depth >= e.depth) {
-        e.key = key;
-        e.depth = depth;
-        e.score = score;
-        e.flag = flag;
-        e.bestMove = bestMove;
+inline void storeTT(uint64_t key, int depth, int score, TTFlag flag, uint16_t bestMove) {
+    TRACE_SCOPE(StoreTT);
+    TTSlot& slot = TT[key & (TTSIZE - 1)];
+    uint64_t oldData = slot.data.load(std::memory_order_relaxed);
+    if (oldData == 0 || depth >= int8_t(oldData >> 32)) {
+        uint64_t data = packTTData(depth, score, flag, bestMove);
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.key.store(key ^ data, std::memory_order_relaxed);
     }
 }
@@ -0,0 +1,149 @@
+#include "Trace.h"
+
+#ifdef ENGINE_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const char* TRACE_EVENT_NAMES[int(TraceEvent::Count)] = {
+    "generateLegalMoves", "isLegal", "makeMove", "unmakeMove", "evaluate", "probeTT", "storeTT"
+};
+
+//Written by its owner thread only. count is atomic so a dump sees whole records
+struct TraceBuffer {
+    std::vector<TraceRecord> records = std::vector<TraceRecord>(TRACE_BUFFER_SIZE);
+    std::atomic<uint64_t> count{0};
+    uint32_t threadId = 0;
+};
+
+//Buffers outlive their threads, so a dump still sees the work of finished search threads
+static std::mutex traceBuffersMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> traceBuffers;
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+//The lock is only taken once per thread, on its first record
+static TraceBuffer& threadBuffer() {
+    thread_local TraceBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(traceBuffersMutex);
+        traceBuffers.push_back(std::make_unique<TraceBuffer>());
+        buffer = traceBuffers.back().get();
+        buffer->threadId = uint32_t(traceBuffers.size());
+    }
+    return *buffer;
+}
+
+uint64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void traceRecord(TraceEvent event, uint64_t start, uint64_t end) {
+    TraceBuffer& buffer = threadBuffer();
+    uint64_t index = buffer.count.load(std::memory_order_relaxed);
+    buffer.records[index & (TRACE_BUFFER_SIZE - 1)] = {start, uint32_t(end - start), event};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+//Records still in a buffer, ordered by start time with enclosing scopes first
+static std::vector<TraceRecord> snapshot(const TraceBuffer& buffer) {
+    uint64_t count = buffer.count.load(std::memory_order_acquire);
+    uint64_t first = count > TRACE_BUFFER_SIZE ? count - TRACE_BUFFER_SIZE : 0;
+    std::vector<TraceRecord> records;
+    records.reserve(count - first);
+    for (uint64_t i = first; i < count; i++) {
+        records.push_back(buffer.records[i & (TRACE_BUFFER_SIZE - 1)]);
+    }
+    std::sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) {
+        return a.start != b.start ? a.start < b.start : a.duration > b.duration;
+    });
+    return records;
+}
+
+//Chrome wants microseconds, the fraction keeps the nanoseconds of the short scopes
+static void writeMicros(std::ofstream& out, uint64_t nanos) {
+    out << nanos / 1000 << "." << std::setw(3) << std::setfill('0') << nanos % 1000 << std::setfill(' ');
+}
+
+bool dumpTraceChrome(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(traceBuffersMutex);
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const std::unique_ptr<TraceBuffer>& buffer : traceBuffers) {
+        for (const TraceRecord& record : snapshot(*buffer)) {
+            out << (first ? "" : ",\n") << "{\"name\":\"" << TRACE_EVENT_NAMES[int(record.event)]
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":";
+            writeMicros(out, record.start);
+            out << ",\"dur\":";
+            writeMicros(out, record.duration);
+            out << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    return bool(out);
+}
+
+bool dumpTraceFolded(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    //Rebuilds the call stacks from interval nesting, each frame keeps its time minus its children's
+    struct Frame {
+        uint64_t end;
+        std::string stack;
+        uint64_t selfTime;
+    };
+    std::map<std::string, uint64_t> folded;
+    std::lock_guard<std::mutex> lock(traceBuffersMutex);
+    for (const std::unique_ptr<TraceBuffer>& buffer : traceBuffers) {
+        std::vector<Frame> stack;
+        auto closeFrame = [&]() {
+            folded[stack.back().stack] += stack.back().selfTime;
+            stack.pop_back();
+        };
+        for (const TraceRecord& record : snapshot(*buffer)) {
+            while (!stack.empty() && stack.back().end <= record.start) {
+                closeFrame();
+            }
+            if (!stack.empty()) {
+                stack.back().selfTime -= std::min<uint64_t>(stack.back().selfTime, record.duration);
+            }
+            std::string name = TRACE_EVENT_NAMES[int(record.event)];
+            stack.push_back({record.start + record.duration, stack.empty() ? name : stack.back().stack + ";" + name, record.duration});
+        }
+        while (!stack.empty()) {
+            closeFrame();
+        }
+    }
+    for (const auto& [frames, nanos] : folded) {
+        out << frames << " " << nanos << "\n";
+    }
+    return bool(out);
+}
+
+void clearTrace() {
+    std::lock_guard<std::mutex> lock(traceBuffersMutex);
+    for (const std::unique_ptr<TraceBuffer>& buffer : traceBuffers) {
+        buffer->count.store(0, std::memory_order_release);
+    }
+}
+
+#else
+
+bool dumpTraceChrome(const std::string&) { return false; }
+bool dumpTraceFolded(const std::string&) { return false; }
+void clearTrace() {}
+
+#endif
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#pragma once
+
+//Hot path tracing, compiled in only with the ENGINE_TRACE CMake option. Without it TRACE_SCOPE expands
+//to nothing and the dump functions just return false.
+//Every thread records into its own ring buffer, so the search never takes a lock for it. The oldest
+//records are overwritten once a buffer is full. Dump after the searches have finished
+
+enum class TraceEvent : uint8_t {
+    GenerateLegalMoves,
+    IsLegal,
+    MakeMove,
+    UnmakeMove,
+    Evaluate,
+    ProbeTT,
+    StoreTT,
+    Count
+};
+
+//Chrome's trace viewer / Perfetto format, one complete event per record
+bool dumpTraceChrome(const std::string& path);
+//Folded stacks ("generateLegalMoves;isLegal;makeMove 1234", self time in ns) for flamegraph.pl and speedscope
+bool dumpTraceFolded(const std::string& path);
+//Drops everything recorded so far
+void clearTrace();
+
+#ifdef ENGINE_TRACE
+
+constexpr size_t TRACE_BUFFER_SIZE = 1 << 20; // records per thread, 16MB
+
+struct TraceRecord {
+    uint64_t start;     // ns since the trace clock started
+    uint32_t duration;  // ns
+    TraceEvent event;
+};
+
+uint64_t traceNow();
+void traceRecord(TraceEvent event, uint64_t start, uint64_t end);
+
+//Records the time between its construction and the end of the enclosing scope
+class TraceScope {
+    public:
+        explicit TraceScope(TraceEvent event) : event(event), start(traceNow()) {}
+        ~TraceScope() { traceRecord(event, start, traceNow()); }
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+    private:
+        TraceEvent event;
+        uint64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(event) TraceScope TRACE_CONCAT(traceScope, __LINE__)(TraceEvent::event)
+
+#else
+
+#define TRACE_SCOPE(event) ((void)0)
+
+#endif
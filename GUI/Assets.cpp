@@ -0,0 +1,95 @@
+#include "Assets.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+//loadAsync adds every key before the loader starts, so the maps never change shape while it runs.
+//The loader fills in one asset at a time and then marks it ready
+static std::unordered_map<std::string, sf::Image> images;
+static std::unordered_map<std::string, sf::Font> fonts;
+static std::unordered_map<std::string, sf::SoundBuffer> sounds;
+static std::unordered_map<std::string, std::shared_future<bool>> ready;
+static std::future<void> assetLoader;
+
+//Render thread only
+static std::unordered_map<std::string, std::unique_ptr<sf::Texture>> textures;
+
+void Assets::loadAsync(const std::string& directory, const std::vector<std::string>& first) {
+	struct Job {
+		std::string name;
+		std::string path;
+		std::string extension;
+		std::promise<bool> loaded;
+	};
+	std::vector<Job> jobs;
+	std::error_code error;
+	for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error)) {
+		Job job{file.path().lexically_relative(directory).generic_string(), file.path().string(), file.path().extension().string(), {}};
+		if (job.extension == ".png") images[job.name];
+		else if (job.extension == ".ttf") fonts[job.name];
+		else if (job.extension == ".wav") sounds[job.name];
+		else continue;
+		ready[job.name] = job.loaded.get_future().share();
+		jobs.push_back(std::move(job));
+	}
+	//What the first screen shows is decoded before everything else
+	std::stable_partition(jobs.begin(), jobs.end(), [&first](const Job& job) {
+		return std::find(first.begin(), first.end(), job.name) != first.end();
+	});
+
+	assetLoader = std::async(std::launch::async, [jobs = std::move(jobs)]() mutable {
+		auto start = std::chrono::steady_clock::now();
+		for (Job& job : jobs) {
+			bool loaded = job.extension == ".png" ? images.at(job.name).loadFromFile(job.path)
+				: job.extension == ".ttf" ? fonts.at(job.name).openFromFile(job.path)
+				: sounds.at(job.name).loadFromFile(job.path);
+			if (!loaded) {
+				std::cerr << "Failed to load asset " << job.path << std::endl;
+			}
+			job.loaded.set_value(loaded);
+		}
+		std::cout << jobs.size() << " assets loaded in "
+			<< std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << "ms" << std::endl;
+	});
+}
+
+//Waits for this asset only, the loader may still be busy with the others
+template <typename T>
+static const T& findAsset(const std::unordered_map<std::string, T>& assets, const std::string& name) {
+	auto it = assets.find(name);
+	auto loaded = ready.find(name);
+	if (it == assets.end() || loaded == ready.end() || !loaded->second.get()) {
+		throw std::invalid_argument("couldnt find asset " + name);
+	}
+	return it->second;
+}
+
+const sf::Image& Assets::getImage(const std::string& name) {
+	return findAsset(images, name);
+}
+
+const sf::Font& Assets::getFont(const std::string& name) {
+	return findAsset(fonts, name);
+}
+
+const sf::SoundBuffer& Assets::getSound(const std::string& name) {
+	return findAsset(sounds, name);
+}
+
+const sf::Texture& Assets::getTexture(const std::string& name) {
+	auto it = textures.find(name);
+	if (it != textures.end()) {
+		return *it->second;
+	}
+	//Only cached once the upload worked, a failed one is retried on the next request
+	auto texture = std::make_unique<sf::Texture>();
+	if (!texture->loadFromImage(getImage(name))) {
+		throw std::runtime_error("couldnt upload texture " + name);
+	}
+	return *textures.emplace(name, std::move(texture)).first->second;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "SFML/Graphics.hpp"
+#include <SFML/Audio.hpp>
+#include <string>
+#include <vector>
+
+//Process wide cache of everything under the assets directory. Images, fonts and sounds are decoded once
+//on a background thread started at launch, screens only ask for shared references.
+//Names are paths relative to the assets directory with forward slashes, like "img/whitePawn.png"
+class Assets {
+public:
+	//Starts decoding every .png, .ttf and .wav below directory, the names in first before the rest.
+	//Only lists the directory before returning
+	static void loadAsync(const std::string& directory, const std::vector<std::string>& first = {});
+
+	//The getters wait until their own asset is decoded and throw if it doesn't exist or failed to load.
+	//References stay valid for the rest of the program
+	static const sf::Image& getImage(const std::string& name);
+	static const sf::Font& getFont(const std::string& name);
+	static const sf::SoundBuffer& getSound(const std::string& name);
+
+	//Uploaded to the GPU on the first request, which has to come from the render thread
+	static const sf::Texture& getTexture(const std::string& name);
+};
@@ -6,11 +6,10 @@
 #include <stdexcept>
 
 
-Button::Button(sf::Vector2f textCenterPos, sf::Font font, std::string txt, int fontSize, 
+Button::Button(sf::Vector2f textCenterPos, const sf::Font& font, std::string txt, int fontSize, 
 	sf::Color color, sf::Color colorOnHover, float rectAmplifyingValue) : text(font, ""){
 	this->textCenterPos = textCenterPos;
-	this->font = font;
-	this->text.setFont(this->font);
+	this->font = &font;
 
 	this->textString = txt;
 	this->text.setString(textString);
@@ -7,7 +7,7 @@ class Button
 {
 public:
 	sf::Vector2f textCenterPos;
-	sf::Font font;
+	const sf::Font* font;
 	std::string textString;
 	sf::Text text;
 	int fontSize;
@@ -16,7 +16,7 @@ public:
 	sf::Color colorOnHover;
 	sf::Color currentColor;
 
-	Button(sf::Vector2f textCenterPos, sf::Font font, std::string text, int fontSize, sf::Color color,sf::Color colorOnHover, float rectAmplifyingValue);
+	Button(sf::Vector2f textCenterPos, const sf::Font& font, std::string text, int fontSize, sf::Color color,sf::Color colorOnHover, float rectAmplifyingValue);
 
 	bool isHovering(sf::Vector2i mousePos);
 
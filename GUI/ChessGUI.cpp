@@ -5,77 +5,13 @@ ChessGUI::ChessGUI(GUI_SCREENS screen, Board board)
     : GUI(screen),
       chessboard(board),
       squareSize(120),
-      selectedPiece(-1, -1, white, Pawn),
-      whitePawnSprite(whitePawnTexture),
-      blackPawnSprite(blackPawnTexture),
-      whiteKnightSprite(whiteKnightTexture),
-      blackKnightSprite(blackKnightTexture),
-      whiteBishopSprite(whiteBishopTexture),
-      blackBishopSprite(blackBishopTexture),
-      whiteRookSprite(whiteRookTexture),
-      blackRookSprite(blackRookTexture),
-      whiteQueenSprite(whiteQueenTexture),
-      blackQueenSprite(blackQueenTexture),
-      whiteKingSprite(whiteKingTexture),
-      blackKingSprite(blackKingTexture)
+      selectedPiece(-1, -1, white, Pawn)
 {
 	this->mode = screen;
 	this->chessboard = board;
 	
 	this->squareSize = 120;
 	this->selectedPiece = Piece(-1,-1,white,Pawn);
-
-	if (!whitePawnTexture.loadFromFile("..\\assets\\img\\whitePawn.png")) {
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->whitePawnSprite = sf::Sprite(whitePawnTexture);
-
-	if (!blackPawnTexture.loadFromFile("..\\assets\\img\\blackPawn.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->blackPawnSprite = sf::Sprite(blackPawnTexture);
-
-	if (!whiteKnightTexture.loadFromFile("..\\assets\\img\\whiteKnight.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->whiteKnightSprite = sf::Sprite(whiteKnightTexture);
-	if (!blackKnightTexture.loadFromFile("..\\assets\\img\\blackKnight.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->blackKnightSprite = sf::Sprite(blackKnightTexture);
-	if (!whiteBishopTexture.loadFromFile("..\\assets\\img\\whiteBishop.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->whiteBishopSprite = sf::Sprite(whiteBishopTexture);
-	if (!blackBishopTexture.loadFromFile("..\\assets\\img\\blackBishop.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->blackBishopSprite = sf::Sprite(blackBishopTexture);
-	if (!whiteRookTexture.loadFromFile("..\\assets\\img\\whiteRook.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->whiteRookSprite = sf::Sprite(whiteRookTexture);
-	if (!blackRookTexture.loadFromFile("..\\assets\\img\\blackRook.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->blackRookSprite = sf::Sprite(blackRookTexture);
-	if (!whiteQueenTexture.loadFromFile("..\\assets\\img\\whiteQueen.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->whiteQueenSprite = sf::Sprite(whiteQueenTexture);
-	if (!blackQueenTexture.loadFromFile("..\\assets\\img\\blackQueen.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->blackQueenSprite = sf::Sprite(blackQueenTexture);
-	if (!whiteKingTexture.loadFromFile("..\\assets\\img\\whiteKing.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->whiteKingSprite = sf::Sprite(whiteKingTexture);
-	
-	if (!blackKingTexture.loadFromFile("..\\assets\\img\\blackKing.png")){
-		std::cerr << "Failed to load texture" << std::endl;
-	}
-	this->blackKingSprite = sf::Sprite(blackKingTexture);
 }
 
 void ChessGUI::drawChessBoard(sf::RenderWindow& window, sf::Vector2i offset) {
@@ -105,19 +41,9 @@ void ChessGUI::drawSelectedPieceSquare(sf::RenderWindow& window, sf::Vector2i of
 }
 
 void ChessGUI::drawPieces(sf::RenderWindow& window, sf::Vector2i offset) {
-	this->drawPawns(white, window, offset);
-	this->drawPawns(black, window, offset);
-	this->drawKnights(white, window, offset);
-	this->drawKnights(black, window, offset);
-	this->drawBishops(white, window, offset);
-	this->drawBishops(black, window, offset);
-	this->drawRooks(white, window, offset);
-	this->drawRooks(black, window, offset);
-	this->drawQueens(white, window, offset);
-	this->drawQueens(black, window, offset);
-	this->drawKing(white, window, offset);
-	this->drawKing(black, window, offset);
-
+	//The selected piece is drawn on its own by drawSelectedPiece
+	int selectedSquare = this->selectedPiece.pos == std::make_pair(-1, -1) ? -1 : convertGridCoords(this->selectedPiece.pos);
+	this->pieceRenderer.draw(window, this->chessboard, offset, this->squareSize, selectedSquare, false);
 }
 
 std::pair<int,int> convertGridCoords(int square){
@@ -134,190 +60,6 @@ int convertGridCoords(std::pair<int,int> square){
     return rankFromBottom * 8 + x;  // little-endian square index
 }
 
-void ChessGUI::drawKnights(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteKnightSprite : this->blackKnightSprite;
-	if (color == white) {
-		currBoard = this->chessboard.whiteKnights;
-	}
-	else {
-		currBoard = this->chessboard.blackKnights;
-	}
-
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords(targetSquare);
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		if (gridCoords == this->selectedPiece.pos) { continue; }
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x* this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void ChessGUI::drawPawns(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whitePawnSprite : this->blackPawnSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whitePawns;
-	}
-	else {
-		currBoard = this->chessboard.blackPawns;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords(targetSquare);
-		if (gridCoords == this->selectedPiece.pos) { continue; }
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void ChessGUI::drawBishops(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteBishopSprite : this->blackBishopSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteBishops;
-	}
-	else {
-		currBoard = this->chessboard.blackBishops;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords(targetSquare);
-		if (gridCoords == this->selectedPiece.pos) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void ChessGUI::drawRooks(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteRookSprite : this->blackRookSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteRooks;
-	}
-	else {
-		currBoard = this->chessboard.blackRooks;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords(targetSquare);
-		if (gridCoords == this->selectedPiece.pos) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void ChessGUI::drawKing(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteKingSprite : this->blackKingSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteKing;
-	}
-	else {
-		currBoard = this->chessboard.blackKing;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords(targetSquare);
-		if (gridCoords == this->selectedPiece.pos) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void ChessGUI::drawQueens(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteQueenSprite : this->blackQueenSprite; 
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteQueens;
-	}
-	else {
-		currBoard = this->chessboard.blackQueens;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords(targetSquare);
-		if (gridCoords == this->selectedPiece.pos) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
 std::pair<int, int> ChessGUI::getGridOfClick(sf::Vector2i mousePos, sf::Vector2i offset) {
 	mousePos -= offset;
 
@@ -359,17 +101,8 @@ void ChessGUI::processClick(int clickEvent, sf::RenderWindow& window, sf::Vector
 			//Clicking in and empty square or clicking in square of opposite color
 			if ((((combinedSameColorBoard ) & (1ULL <<oneDimensionalClick)) == 0 )) {
 				Move attemptedMove;
-				MoveGenerator gen(this->chessboard);
-				int moveCount = 0;
-				gen.generateLegalMoves(moves,moveCount,0);
-				bool flag = false;
-				for (int i = 0; i < moveCount; i++){
-					Move currMove = moves[0][i];
-					if (currMove.to == convertGridCoords(gridPos) && currMove.from == convertGridCoords(this->selectedPiece.pos)){
-						flag = true;
-						attemptedMove = currMove;
-					}
-				}
+				this->moveCache.update(this->chessboard);
+				bool flag = this->moveCache.findMove(convertGridCoords(this->selectedPiece.pos), convertGridCoords(gridPos), attemptedMove);
 
 				if (flag) {
 					
@@ -382,8 +115,9 @@ void ChessGUI::processClick(int clickEvent, sf::RenderWindow& window, sf::Vector
 					
 					this->clearSelectedPiece();
 
-					int moveCount = 0;
-					gen.generateLegalMoves(moves,moveCount,0);
+					this->moveCache.update(this->chessboard);
+					int moveCount = this->moveCache.count();
+					MoveGenerator gen(this->chessboard);
 					if (this->chessboard.whiteToMove) {
 				
 						if (moveCount == 0) {
@@ -428,17 +162,8 @@ void ChessGUI::processClick(int clickEvent, sf::RenderWindow& window, sf::Vector
 		if (centeredMousePos.x >= 0 && centeredMousePos.x <= this->squareSize * 8 &&
 			centeredMousePos.y >= 0 && centeredMousePos.y <= this->squareSize * 8) {
 			Move attemptedMove;
-				MoveGenerator gen(this->chessboard);
-				int moveCount = 0;
-				gen.generateLegalMoves(moves,moveCount,0);
-				bool flag = false;
-				for (int i = 0; i < moveCount; i++){
-					Move currMove = moves[0][i];
-					if (currMove.to == convertGridCoords(gridPos) && currMove.from == convertGridCoords(this->selectedPiece.pos)){
-						flag = true;
-						attemptedMove = currMove;
-					}
-				}
+				this->moveCache.update(this->chessboard);
+				bool flag = this->moveCache.findMove(convertGridCoords(this->selectedPiece.pos), convertGridCoords(gridPos), attemptedMove);
 				if (flag) {
 					
 
@@ -450,8 +175,9 @@ void ChessGUI::processClick(int clickEvent, sf::RenderWindow& window, sf::Vector
 
 					this->clearSelectedPiece();
 
-					int moveCount = 0;
-					gen.generateLegalMoves(moves,moveCount,0);
+					this->moveCache.update(this->chessboard);
+					int moveCount = this->moveCache.count();
+					MoveGenerator gen(this->chessboard);
 					if (this->chessboard.whiteToMove) {
 				
 						if (moveCount == 0) {
@@ -535,28 +261,11 @@ void ChessGUI::clearSelectedPiece() {
 }
 
 sf::Sprite ChessGUI::getSpriteOfPiece(PieceType type, PieceColor color) {
-	switch (type) {
-	case Pawn: 
-		return color == white ? this->whitePawnSprite : this->blackPawnSprite;
-		break;
-	case Knight:
-		return color == white ? this->whiteKnightSprite : this->blackKnightSprite;
-		break;
-	case Bishop:
-		return color == white ? this->whiteBishopSprite : this->blackBishopSprite;
-		break;
-	case Rook:
-		return color == white ? this->whiteRookSprite : this->blackRookSprite;
-		break;
-	case Queen:
-		return color == white ? this->whiteQueenSprite : this->blackQueenSprite;
-		break;
-	case King:
-		return color == white ? this->whiteKingSprite : this->blackKingSprite;
-		break;
+	if (type == None) {
+		std::cerr << "NO TEXTURE FOUND" << std::endl;
+		type = Pawn;
 	}
-	std::cerr << "NO TEXTURE FOUND" << std::endl;
-	return this->whitePawnSprite;
+	return sf::Sprite(this->pieceRenderer.getTexture(), this->pieceRenderer.getPieceRect(type, color));
 }
 
 void ChessGUI::drawSelectedPiece(int clickEvent, sf::RenderWindow& window, sf::Vector2i boardOffset) {
@@ -586,29 +295,27 @@ void ChessGUI::drawSelectedPiece(int clickEvent, sf::RenderWindow& window, sf::V
 void ChessGUI::drawSelectedPiecePossibilities(int clickEvent, sf::RenderWindow& window, sf::Vector2i boardOffset) {
 	if (this->selectedPiece.pos == std::make_pair(-1, -1)) { return; }
 
-	int moveCount = 0;
-	MoveGenerator gen(this->chessboard);
-	gen.generateLegalMoves(moves,moveCount,0);
+	//Only regenerates after the position changed, every other frame just reads the bitboard
+	this->moveCache.update(this->chessboard);
+	uint64_t destinations = this->moveCache.destinations(convertGridCoords(this->selectedPiece.pos));
 
 	sf::Vector2f circlePos;
-	Move move;
-	for (size_t i = 0; i < moveCount; i++) {
-		move = moves[0][i];
-		if (move.from == convertGridCoords(this->selectedPiece.pos)) {
-			circlePos = sf::Vector2f(std::get<0>(convertGridCoords(move.to)) * this->squareSize, std::get<1>(convertGridCoords(move.to)) * this->squareSize);
-			circlePos += sf::Vector2f(boardOffset);
-			circlePos += sf::Vector2f(40, 40);
-			this->drawCircle(window, circlePos,  20, sf::Color(100, 100, 100));
-		}
+	while (destinations) {
+		int to = __builtin_ctzll(destinations);
+		destinations &= destinations - 1;
+		circlePos = sf::Vector2f(std::get<0>(convertGridCoords(to)) * this->squareSize, std::get<1>(convertGridCoords(to)) * this->squareSize);
+		circlePos += sf::Vector2f(boardOffset);
+		circlePos += sf::Vector2f(40, 40);
+		this->drawCircle(window, circlePos,  20, sf::Color(100, 100, 100));
 	}
 }
 
 void ChessGUI::handlePromotions(Move& move, sf::RenderWindow& window) {
 	//Create buttons
-	Button queenButton = Button(sf::Vector2f(250, 100), this->font, "QUEEN", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
-	Button rookButton = Button(sf::Vector2f(250, 200), this->font, "ROOK", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
-	Button knightButton = Button(sf::Vector2f(250, 300), this->font, "KNIGHT", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
-	Button bishopButton = Button(sf::Vector2f(250, 400), this->font, "BISHOP", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
+	Button queenButton = Button(sf::Vector2f(250, 100), *this->font, "QUEEN", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
+	Button rookButton = Button(sf::Vector2f(250, 200), *this->font, "ROOK", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
+	Button knightButton = Button(sf::Vector2f(250, 300), *this->font, "KNIGHT", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
+	Button bishopButton = Button(sf::Vector2f(250, 400), *this->font, "BISHOP", 20, sf::Color(220, 220, 220), sf::Color(150, 150, 150), 20);
 	
 	this->buttons.emplace_back(queenButton);
 	this->buttons.emplace_back(knightButton);
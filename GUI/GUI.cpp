@@ -11,7 +11,7 @@ void GUI::changeMode(GUI_SCREENS newMode) {
     this->mode = newMode;
 }
 
-GUI::GUI(GUI_SCREENS screen, sf::Texture backgroundTexture) : backgroundSprite(backgroundTexture) {
+GUI::GUI(GUI_SCREENS screen, const sf::Texture& backgroundTexture) : backgroundSprite(backgroundTexture) {
     this->mode = screen;
 }
 GUI::GUI() : backgroundSprite(emptyTexture) {}
@@ -34,7 +34,7 @@ void GUI::drawBackground(sf::RenderWindow& window) {
     window.draw(this->backgroundSprite);
 }
 
-void GUI::setBackground(sf::Texture& texture,sf::Vector2f windowSize) {
+void GUI::setBackground(const sf::Texture& texture,sf::Vector2f windowSize) {
     this->backgroundSprite.setTexture(texture);
     sf::FloatRect bounds = this->backgroundSprite.getLocalBounds();
 
@@ -58,10 +58,12 @@ void GUI::drawCircle(sf::RenderWindow& window, sf::Vector2f pos, float radius, s
 //If button released return 2
 // If button is currently pressed but not in the current event return 3
 int GUI::processEventsAndReturnOnClick(sf::RenderWindow& window) {
+    this->hadEvent = false;
     while (const std::optional ev = window.pollEvent())
     {
         if (ev.has_value()){
             sf::Event event = ev.value();
+            this->hadEvent = true;
 
             
             for (TextBox& tb : this->textBoxes) {
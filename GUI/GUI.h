@@ -16,10 +16,12 @@ public:
 	sf::Sprite backgroundSprite;
 	std::vector<Button> buttons;
 	std::vector<TextBox> textBoxes;
+	//Set when the last processEventsAndReturnOnClick saw any event, so the screen knows to redraw
+	bool hadEvent = false;
 
 	void changeMode(GUI_SCREENS newMode);
 
-	GUI(GUI_SCREENS screen, sf::Texture backgroundTexture);
+	GUI(GUI_SCREENS screen, const sf::Texture& backgroundTexture);
 	GUI(GUI_SCREENS screen);
 	GUI();
 
@@ -29,7 +31,7 @@ public:
 
 	void renderTextBoxes(sf::RenderWindow& window, bool hasClicked);
 
-	void setBackground(sf::Texture& texture,sf::Vector2f windowSize);
+	void setBackground(const sf::Texture& texture,sf::Vector2f windowSize);
 
 	void drawCircle(sf::RenderWindow& window, sf::Vector2f pos, float radius, sf::Color color);
 
@@ -0,0 +1,36 @@
+#include "LegalMoveCache.h"
+#include "../Engine/MoveGenerator.h"
+#include <algorithm>
+
+void LegalMoveCache::update(Board& board) {
+	if (this->valid && this->key == board.zobristHash) { return; }
+
+	//Generated into the ply 0 buffer like before, then copied out so later generations can't clobber it
+	MoveGenerator gen(board);
+	this->moveCount = 0;
+	gen.generateLegalMoves(moves, this->moveCount, 0);
+	std::copy(moves[0], moves[0] + this->moveCount, this->legalMoves);
+
+	std::fill(this->targets, this->targets + 64, 0ULL);
+	for (int i = 0; i < this->moveCount; i++) {
+		this->targets[this->legalMoves[i].from] |= 1ULL << this->legalMoves[i].to;
+	}
+	this->key = board.zobristHash;
+	this->valid = true;
+}
+
+uint64_t LegalMoveCache::destinations(int from) const {
+	if (from < 0 || from >= 64) { return 0; }
+	return this->targets[from];
+}
+
+bool LegalMoveCache::findMove(int from, int to, Move& move) const {
+	if (to < 0 || to >= 64 || (this->destinations(from) & (1ULL << to)) == 0) { return false; }
+	for (int i = 0; i < this->moveCount; i++) {
+		if (this->legalMoves[i].from == from && this->legalMoves[i].to == to) {
+			move = this->legalMoves[i];
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "../Engine/Board.h"
+#include "../Engine/Move.h"
+#include <cstdint>
+
+//Legal moves of the position on screen, generated once per position instead of once per frame.
+//Keyed by Board::zobristHash, so undo, network moves and bot moves all invalidate it on their own
+class LegalMoveCache {
+public:
+	//Regenerates the moves only if the board changed since the last call
+	void update(Board& board);
+
+	//Bitboard of the squares the piece on from can move to
+	uint64_t destinations(int from) const;
+
+	//Finds the legal move from -> to. For promotions this is one of the four, the caller picks the piece
+	bool findMove(int from, int to, Move& move) const;
+
+	int count() const { return this->moveCount; }
+
+private:
+	bool valid = false;
+	uint64_t key = 0;
+	int moveCount = 0;
+	Move legalMoves[MAX_MOVES];
+	uint64_t targets[64] = {};
+};
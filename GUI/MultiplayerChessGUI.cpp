@@ -21,213 +21,8 @@ int convertGridCoords2(std::pair<int,int> square){
 }
 
 void MultiplayerChessGUI::drawPieces(sf::RenderWindow& window, sf::Vector2i offset) {
-	this->drawPawns(white, window, offset);
-	this->drawPawns(black, window, offset);
-	this->drawKnights(white, window, offset);
-	this->drawKnights(black, window, offset);
-	this->drawBishops(white, window, offset);
-	this->drawBishops(black, window, offset);
-	this->drawRooks(white, window, offset);
-	this->drawRooks(black, window, offset);
-	this->drawQueens(white, window, offset);
-	this->drawQueens(black, window, offset);
-	this->drawKing(white, window, offset);
-	this->drawKing(black, window, offset);
-
-}
-
-void MultiplayerChessGUI::drawKnights(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteKnightSprite : this->blackKnightSprite;
-	if (color == white) {
-		currBoard = this->chessboard.whiteKnights;
-	}
-	else {
-		currBoard = this->chessboard.blackKnights;
-	}
-
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords2(targetSquare);
-		gridCoords = convertCoordsByColor(gridCoords);
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		if (gridCoords == convertCoordsByColor(this->selectedPiece.pos)) { continue; }
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x* this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void MultiplayerChessGUI::drawPawns(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whitePawnSprite : this->blackPawnSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whitePawns;
-	}
-	else {
-		currBoard = this->chessboard.blackPawns;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords2(targetSquare);
-		gridCoords = convertCoordsByColor(gridCoords);
-		if (gridCoords == convertCoordsByColor(this->selectedPiece.pos)) { continue; }
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void MultiplayerChessGUI::drawBishops(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteBishopSprite : this->blackBishopSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteBishops;
-	}
-	else {
-		currBoard = this->chessboard.blackBishops;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords2(targetSquare);
-		gridCoords = convertCoordsByColor(gridCoords);
-
-		if (gridCoords == convertCoordsByColor(this->selectedPiece.pos)) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void MultiplayerChessGUI::drawRooks(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteRookSprite : this->blackRookSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteRooks;
-	}
-	else {
-		currBoard = this->chessboard.blackRooks;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords2(targetSquare);
-		gridCoords = convertCoordsByColor(gridCoords);
-
-		if (gridCoords == convertCoordsByColor(this->selectedPiece.pos)) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void MultiplayerChessGUI::drawKing(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteKingSprite : this->blackKingSprite;
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteKing;
-	}
-	else {
-		currBoard = this->chessboard.blackKing;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords2(targetSquare);
-		gridCoords = convertCoordsByColor(gridCoords);
-
-		if (gridCoords == convertCoordsByColor(this->selectedPiece.pos)) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
-}
-
-void MultiplayerChessGUI::drawQueens(PieceColor color, sf::RenderWindow& window, sf::Vector2i offset) {
-	uint64_t currBoard;
-	sf::Sprite currSprite = color == white ? this->whiteQueenSprite : this->blackQueenSprite; 
-
-	if (color == white) {
-		currBoard = this->chessboard.whiteQueens;
-	}
-	else {
-		currBoard = this->chessboard.blackQueens;
-	}
-
-
-	std::pair<int, int> gridCoords;
-	int x;
-	int y;
-
-
-	while (currBoard){
-        int targetSquare = __builtin_ctzll(currBoard);
-		currBoard &= currBoard -1 ;
-		gridCoords = convertGridCoords2(targetSquare);
-		gridCoords = convertCoordsByColor(gridCoords);
-
-		if (gridCoords == convertCoordsByColor(this->selectedPiece.pos)) { continue; }
-
-		x = std::get<0>(gridCoords);
-		y = std::get<1>(gridCoords);
-		currSprite.setScale(sf::Vector2f(2, 2));
-		currSprite.setPosition(sf::Vector2f(offset) + sf::Vector2f(x * this->squareSize, y * this->squareSize));
-		window.draw(currSprite);
-	}
+	int selectedSquare = this->selectedPiece.pos == std::make_pair(-1, -1) ? -1 : convertGridCoords2(this->selectedPiece.pos);
+	this->pieceRenderer.draw(window, this->chessboard, offset, this->squareSize, selectedSquare, this->clientColor == black);
 }
 
 std::pair<int, int> MultiplayerChessGUI::convertCoordsByColor(std::pair<int, int> coords) {
@@ -350,17 +145,8 @@ void MultiplayerChessGUI::processClick(int clickEvent, sf::RenderWindow& window,
 			if ((((combinedSameColorBoard) & (1ULL << oneDimensionalClick)) == 0)) {
 
 				Move attemptedMove;
-				MoveGenerator gen(this->chessboard);
-				int moveCount = 0;
-				gen.generateLegalMoves(moves,moveCount,0);
-				bool flag = false;
-				for (int i = 0; i < moveCount; i++){
-					Move currMove = moves[0][i];
-					if (currMove.to == convertGridCoords2(convertCoordsByColor(gridPos)) && currMove.from == convertGridCoords2(this->selectedPiece.pos)){
-						flag = true;
-						attemptedMove = currMove;
-					}
-				}
+				this->moveCache.update(this->chessboard);
+				bool flag = this->moveCache.findMove(convertGridCoords2(this->selectedPiece.pos), convertGridCoords2(convertCoordsByColor(gridPos)), attemptedMove);
 
 				if (flag) {
 					if (this->isTherePromotion(attemptedMove)) {
@@ -371,8 +157,9 @@ void MultiplayerChessGUI::processClick(int clickEvent, sf::RenderWindow& window,
 					
 					this->clearSelectedPiece();
 
-					int moveCount = 0;
-					gen.generateLegalMoves(moves,moveCount,0);
+					this->moveCache.update(this->chessboard);
+					int moveCount = this->moveCache.count();
+					MoveGenerator gen(this->chessboard);
 					if (this->chessboard.whiteToMove) {
 				
 						if (moveCount == 0) {
@@ -416,17 +203,8 @@ void MultiplayerChessGUI::processClick(int clickEvent, sf::RenderWindow& window,
 		if (centeredMousePos.x >= 0 && centeredMousePos.x <= this->squareSize * 8 &&
 			centeredMousePos.y >= 0 && centeredMousePos.y <= this->squareSize * 8) {
 			Move attemptedMove;
-				MoveGenerator gen(this->chessboard);
-				int moveCount = 0;
-				gen.generateLegalMoves(moves,moveCount,0);
-				bool flag = false;
-				for (int i = 0; i < moveCount; i++){
-					Move currMove = moves[0][i];
-					if (currMove.to == convertGridCoords2(convertCoordsByColor(gridPos)) && currMove.from == convertGridCoords2(this->selectedPiece.pos)){
-						flag = true;
-						attemptedMove = currMove;
-					}
-				}
+				this->moveCache.update(this->chessboard);
+				bool flag = this->moveCache.findMove(convertGridCoords2(this->selectedPiece.pos), convertGridCoords2(convertCoordsByColor(gridPos)), attemptedMove);
 				if (flag) {
 					
 
@@ -438,8 +216,9 @@ void MultiplayerChessGUI::processClick(int clickEvent, sf::RenderWindow& window,
 
 					this->clearSelectedPiece();
 
-					int moveCount = 0;
-					gen.generateLegalMoves(moves,moveCount,0);
+					this->moveCache.update(this->chessboard);
+					int moveCount = this->moveCache.count();
+					MoveGenerator gen(this->chessboard);
 					if (this->chessboard.whiteToMove) {
 				
 						if (moveCount == 0) {
@@ -484,19 +263,16 @@ void MultiplayerChessGUI::drawSelectedPieceSquare(sf::RenderWindow& window, sf::
 void MultiplayerChessGUI::drawSelectedPiecePossibilities(int clickEvent, sf::RenderWindow& window, sf::Vector2i boardOffset) {
 	if (this->selectedPiece.pos == std::make_pair(-1, -1)) { return; }
 
-	int moveCount = 0;
-	MoveGenerator gen(this->chessboard);
-	gen.generateLegalMoves(moves,moveCount,0);
+	this->moveCache.update(this->chessboard);
+	uint64_t destinations = this->moveCache.destinations(convertGridCoords2(this->selectedPiece.pos));
 
 	sf::Vector2f circlePos;
-	Move move;
-	for (size_t i = 0; i < moveCount; i++) {
-		move = moves[0][i];
-		if (move.from == convertGridCoords2(this->selectedPiece.pos)) {
-			circlePos = sf::Vector2f(std::get<0>(convertCoordsByColor(convertGridCoords2(move.to))) * this->squareSize, std::get<1>(convertCoordsByColor(convertGridCoords2(move.to))) * this->squareSize);
-			circlePos += sf::Vector2f(boardOffset);
-			circlePos += sf::Vector2f(40, 40);
-			this->drawCircle(window, circlePos,  20, sf::Color(100, 100, 100));
-		}
+	while (destinations) {
+		int to = __builtin_ctzll(destinations);
+		destinations &= destinations - 1;
+		circlePos = sf::Vector2f(std::get<0>(convertCoordsByColor(convertGridCoords2(to))) * this->squareSize, std::get<1>(convertCoordsByColor(convertGridCoords2(to))) * this->squareSize);
+		circlePos += sf::Vector2f(boardOffset);
+		circlePos += sf::Vector2f(40, 40);
+		this->drawCircle(window, circlePos,  20, sf::Color(100, 100, 100));
 	}
 }
@@ -0,0 +1,85 @@
+#include "NetProtocol.h"
+#include "../Engine/MoveGenerator.h"
+
+static void writeU16(uint8_t* out, uint16_t value) {
+	out[0] = uint8_t(value >> 8);
+	out[1] = uint8_t(value);
+}
+
+static void writeU32(uint8_t* out, uint32_t value) {
+	out[0] = uint8_t(value >> 24);
+	out[1] = uint8_t(value >> 16);
+	out[2] = uint8_t(value >> 8);
+	out[3] = uint8_t(value);
+}
+
+static uint16_t readU16(const uint8_t* in) {
+	return uint16_t((in[0] << 8) | in[1]);
+}
+
+static uint32_t readU32(const uint8_t* in) {
+	return (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 8) | uint32_t(in[3]);
+}
+
+size_t encodeMessage(const NetMessage& message, uint8_t* out) {
+	writeU16(out, uint16_t(MESSAGE_PAYLOAD_SIZE));
+	out[2] = PROTOCOL_VERSION;
+	out[3] = uint8_t(message.type);
+	writeU32(out + 4, message.sequence);
+	writeU16(out + 8, message.move);
+	writeU32(out + 10, message.whiteClockMs);
+	writeU32(out + 14, message.blackClockMs);
+	return MESSAGE_FRAME_SIZE;
+}
+
+void FrameReader::append(const uint8_t* data, size_t size) {
+	this->pending.insert(this->pending.end(), data, data + size);
+}
+
+FrameReader::Result FrameReader::next(NetMessage& message) {
+	while (true) {
+		if (this->pending.size() < FRAME_HEADER_SIZE) { return Incomplete; }
+
+		size_t length = readU16(this->pending.data());
+		if (length < MESSAGE_PAYLOAD_SIZE || length > MAX_PAYLOAD_SIZE) { return Invalid; }
+		if (this->pending.size() < FRAME_HEADER_SIZE + length) { return Incomplete; }
+
+		const uint8_t* payload = this->pending.data() + FRAME_HEADER_SIZE;
+		uint8_t version = payload[0];
+		uint8_t type = payload[1];
+		if (version < 1) { return Invalid; }
+		if (type >= uint8_t(MessageType::Hello) && type <= uint8_t(MessageType::Heartbeat)) { break; }
+		//Message types we don't know yet are only legal from a newer peer, which we simply ignore
+		if (version <= PROTOCOL_VERSION) { return Invalid; }
+		this->pending.erase(this->pending.begin(), this->pending.begin() + FRAME_HEADER_SIZE + length);
+	}
+
+	const uint8_t* payload = this->pending.data() + FRAME_HEADER_SIZE;
+	size_t length = readU16(this->pending.data());
+	uint8_t type = payload[1];
+
+	message.type = MessageType(type);
+	message.sequence = readU32(payload + 2);
+	message.move = readU16(payload + 6);
+	message.whiteClockMs = readU32(payload + 8);
+	message.blackClockMs = readU32(payload + 12);
+
+	//Fields past the ones we know are skipped along with the frame
+	this->pending.erase(this->pending.begin(), this->pending.begin() + FRAME_HEADER_SIZE + length);
+	return Ready;
+}
+
+bool decodeNetMove(Board& board, uint16_t packed, Move& move) {
+	//Own buffer so the GUI's move list in moves[0] is not overwritten
+	Move legalMoves[1][MAX_MOVES];
+	int moveCount = 0;
+	MoveGenerator gen(board);
+	gen.generateLegalMoves(legalMoves, moveCount, 0);
+	for (int i = 0; i < moveCount; i++) {
+		if (legalMoves[0][i].pack() == packed) {
+			move = legalMoves[0][i];
+			return true;
+		}
+	}
+	return false;
+}
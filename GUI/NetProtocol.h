@@ -0,0 +1,54 @@
+#pragma once
+#include "../Engine/Board.h"
+#include "../Engine/Move.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Wire format for multiplayer games. Every message is one length prefixed frame,
+//all integers in network byte order:
+//	u16 length (bytes after this field) | u8 version | u8 type | u32 sequence | u16 move | u32 white clock ms | u32 black clock ms
+//Moves travel as Move::pack() and are checked against the legal moves before they touch the board
+
+constexpr uint8_t PROTOCOL_VERSION = 1;
+constexpr size_t FRAME_HEADER_SIZE = 2;
+constexpr size_t MESSAGE_PAYLOAD_SIZE = 16;
+constexpr size_t MESSAGE_FRAME_SIZE = FRAME_HEADER_SIZE + MESSAGE_PAYLOAD_SIZE;
+//Newer versions may append fields or add message types. The known prefix of a frame is read and the
+//rest skipped, frames of unknown type from a newer peer are dropped. Anything longer than this is garbage
+constexpr size_t MAX_PAYLOAD_SIZE = 256;
+
+enum class MessageType : uint8_t {
+	Hello = 1,
+	Move = 2,
+	Heartbeat = 3	// keeps an idle connection alive, carries nothing
+};
+
+struct NetMessage {
+	MessageType type = MessageType::Hello;
+	uint32_t sequence = 0;		// ply of the move, 0 for the first move of the game. In a Hello, the plies the sender already has
+	uint16_t move = 0;			// Move::pack()
+	uint32_t whiteClockMs = 0;	// time used so far by each side, as seen by the sender
+	uint32_t blackClockMs = 0;
+};
+
+//Writes the frame for message into out, which must hold MESSAGE_FRAME_SIZE bytes. Returns the frame size
+size_t encodeMessage(const NetMessage& message, uint8_t* out);
+
+//Reassembles frames from the TCP byte stream, which can split or merge them arbitrarily
+class FrameReader {
+public:
+	enum Result { Incomplete, Ready, Invalid };
+
+	void append(const uint8_t* data, size_t size);
+
+	//Ready fills message and consumes its frame. Invalid means the stream can't be trusted anymore
+	Result next(NetMessage& message);
+
+private:
+	std::vector<uint8_t> pending;
+};
+
+//Turns a packed move from the wire into the matching legal move. Returns false for anything
+//that is not legal in this position, the board is left untouched either way
+bool decodeNetMove(Board& board, uint16_t packed, Move& move);
@@ -0,0 +1,142 @@
+#include "NetworkSession.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+NetworkSession::NetworkSession(sf::IpAddress address, unsigned short port, bool host) : address(address) {
+	this->port = port;
+	this->host = host;
+}
+
+NetworkSession::~NetworkSession() {
+	this->stop();
+}
+
+void NetworkSession::start() {
+	this->stopping = false;
+	this->thread = std::thread(&NetworkSession::run, this);
+}
+
+void NetworkSession::stop() {
+	this->stopping = true;
+	if (this->thread.joinable()) {
+		this->thread.join();
+	}
+}
+
+bool NetworkSession::sendMove(const NetMessage& message) {
+	return this->outgoing.push(message);
+}
+
+bool NetworkSession::pollMove(NetMessage& message) {
+	return this->incoming.pop(message);
+}
+
+void NetworkSession::run() {
+	sf::TcpListener listener;
+	if (this->host && listener.listen(this->port) != sf::Socket::Status::Done) {
+		std::cerr << "Failed to listen on port " << this->port << std::endl;
+		this->state = ConnectionState::Failed;
+		return;
+	}
+
+	while (!this->stopping) {
+		sf::TcpSocket socket;
+		if (!this->waitForPeer(listener, socket)) { continue; }
+		this->runConnection(socket);
+		socket.disconnect();
+		if (!this->stopping) {
+			std::cout << "Connection lost, reconnecting..." << std::endl;
+			this->state = ConnectionState::Connecting;
+		}
+	}
+}
+
+//Gives up after a short timeout so stop() is noticed quickly, the caller just tries again
+bool NetworkSession::waitForPeer(sf::TcpListener& listener, sf::TcpSocket& socket) {
+	if (this->host) {
+		sf::SocketSelector selector;
+		selector.add(listener);
+		return selector.wait(sf::milliseconds(CONNECT_TIMEOUT_MS)) && listener.accept(socket) == sf::Socket::Status::Done;
+	}
+	if (socket.connect(this->address, this->port, sf::milliseconds(CONNECT_TIMEOUT_MS)) == sf::Socket::Status::Done) {
+		return true;
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(CONNECT_TIMEOUT_MS));
+	return false;
+}
+
+//Returns once the connection is dead, corrupt or the session is stopping
+void NetworkSession::runConnection(sf::TcpSocket& socket) {
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point lastReceived = Clock::now();
+	Clock::time_point lastSent = Clock::now();
+	uint8_t frame[MESSAGE_FRAME_SIZE];
+
+	auto send = [&](const NetMessage& message) {
+		lastSent = Clock::now();
+		return socket.send(frame, encodeMessage(message, frame)) == sf::Socket::Status::Done;
+	};
+
+	NetMessage hello;
+	hello.type = MessageType::Hello;
+	hello.sequence = this->plies;
+	if (!send(hello)) { return; }
+
+	FrameReader reader;
+	sf::SocketSelector selector;
+	selector.add(socket);
+	bool peerReady = false;
+	while (!this->stopping) {
+		if (selector.wait(sf::milliseconds(NET_POLL_MS))) {
+			uint8_t buffer[1024];
+			std::size_t received;
+			if (socket.receive(buffer, sizeof(buffer), received) != sf::Socket::Status::Done) { return; }
+			reader.append(buffer, received);
+			lastReceived = Clock::now();
+		}
+
+		NetMessage message;
+		FrameReader::Result result;
+		while ((result = reader.next(message)) == FrameReader::Ready) {
+			if (message.type == MessageType::Hello) {
+				//Resend whatever the peer missed while we were apart
+				for (const NetMessage& sent : this->sentMoves) {
+					if (sent.sequence >= message.sequence && !send(sent)) { return; }
+				}
+				peerReady = true;
+				this->state = ConnectionState::Connected;
+			}
+			else if (message.type == MessageType::Move && message.sequence >= this->plies) {
+				//A move that doesn't fit is asked for again by the Hello after reconnecting
+				if (!this->incoming.push(message)) {
+					std::cerr << "Incoming move queue is full, dropping the connection" << std::endl;
+					return;
+				}
+				this->plies = message.sequence + 1;
+			}
+		}
+		if (result == FrameReader::Invalid) {
+			std::cerr << "Corrupt data from the opponent, dropping the connection" << std::endl;
+			return;
+		}
+
+		if (peerReady) {
+			while (this->outgoing.pop(message)) {
+				this->sentMoves.push_back(message);
+				this->plies = std::max(this->plies, message.sequence + 1);
+				if (!send(message)) { return; }
+			}
+		}
+
+		Clock::time_point now = Clock::now();
+		if (now - lastSent >= std::chrono::milliseconds(HEARTBEAT_INTERVAL_MS)) {
+			NetMessage heartbeat;
+			heartbeat.type = MessageType::Heartbeat;
+			if (!send(heartbeat)) { return; }
+		}
+		if (now - lastReceived >= std::chrono::milliseconds(PEER_TIMEOUT_MS)) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "NetProtocol.h"
+#include "SPSCQueue.h"
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+enum class ConnectionState {
+	Connecting,		// waiting for the peer, also while reconnecting after a drop
+	Connected,
+	Failed			// could not listen on the port, nothing left to retry
+};
+
+constexpr int NET_POLL_MS = 20;
+constexpr int HEARTBEAT_INTERVAL_MS = 1000;
+//Without any bytes from the peer for this long the connection is dropped and reestablished
+constexpr int PEER_TIMEOUT_MS = 5000;
+constexpr int CONNECT_TIMEOUT_MS = 1000;
+
+//Owns the socket on its own thread so the render loop never waits on the network.
+//The GUI hands moves over through lock free queues and only ever polls.
+//The host keeps accepting and the client keeps connecting until stop(). After a reconnect both sides
+//exchange how many plies they have and resend the moves the other one missed
+class NetworkSession {
+public:
+	NetworkSession(sf::IpAddress address, unsigned short port, bool host);
+	~NetworkSession();
+	NetworkSession(const NetworkSession&) = delete;
+	NetworkSession& operator=(const NetworkSession&) = delete;
+
+	void start();
+	void stop();
+
+	//GUI side. sendMove returns false if the outgoing queue is full
+	bool sendMove(const NetMessage& message);
+	bool pollMove(NetMessage& message);
+	ConnectionState getState() const { return this->state.load(std::memory_order_acquire); }
+
+private:
+	sf::IpAddress address;
+	unsigned short port;
+	bool host;
+
+	std::thread thread;
+	std::atomic<bool> stopping{false};
+	std::atomic<ConnectionState> state{ConnectionState::Connecting};
+	SPSCQueue<NetMessage, 64> outgoing;
+	SPSCQueue<NetMessage, 64> incoming;
+
+	//Only touched by the network thread
+	std::vector<NetMessage> sentMoves;
+	uint32_t plies = 0;
+
+	void run();
+	bool waitForPeer(sf::TcpListener& listener, sf::TcpSocket& socket);
+	void runConnection(sf::TcpSocket& socket);
+};
@@ -0,0 +1,83 @@
+#include "PieceRenderer.h"
+#include "Assets.h"
+#include <iostream>
+
+static sf::Texture buildAtlas() {
+	const char* colorNames[2] = {"white", "black"};
+	const char* typeNames[6] = {"Pawn", "Knight", "Bishop", "Rook", "Queen", "King"};
+	const int size = PieceRenderer::PIECE_IMAGE_SIZE;
+
+	sf::Image atlasImage(sf::Vector2u(6 * size, 2 * size), sf::Color::Transparent);
+	for (int color = 0; color < 2; color++) {
+		for (int type = 0; type < 6; type++) {
+			const sf::Image& pieceImage = Assets::getImage(std::string("img/") + colorNames[color] + typeNames[type] + ".png");
+			sf::Vector2u destination(type * size, color * size);
+			if (!atlasImage.copy(pieceImage, destination, sf::IntRect({0, 0}, {size, size}))) {
+				std::cerr << "Failed to copy " << colorNames[color] << typeNames[type] << " into the atlas" << std::endl;
+			}
+		}
+	}
+
+	sf::Texture atlas;
+	if (!atlas.loadFromImage(atlasImage)) {
+		std::cerr << "Failed to load texture" << std::endl;
+	}
+	return atlas;
+}
+
+PieceRenderer::PieceRenderer() {
+	static const sf::Texture sharedAtlas = buildAtlas();
+	this->atlas = &sharedAtlas;
+}
+
+sf::IntRect PieceRenderer::getPieceRect(PieceType type, PieceColor color) const {
+	return sf::IntRect({type * PIECE_IMAGE_SIZE, (color == white ? 0 : 1) * PIECE_IMAGE_SIZE}, {PIECE_IMAGE_SIZE, PIECE_IMAGE_SIZE});
+}
+
+void PieceRenderer::draw(sf::RenderWindow& window, const Board& board, sf::Vector2i offset, int squareSize, int skipSquare, bool flipped) {
+	const uint64_t pieces[2][6] = {
+		{board.whitePawns, board.whiteKnights, board.whiteBishops, board.whiteRooks, board.whiteQueens, board.whiteKing},
+		{board.blackPawns, board.blackKnights, board.blackBishops, board.blackRooks, board.blackQueens, board.blackKing}
+	};
+	uint64_t occupied = board.getCombinedBoard(white) | board.getCombinedBoard(black);
+	if (skipSquare >= 0 && skipSquare < 64) {
+		occupied &= ~(1ULL << skipSquare);
+	}
+
+	//Two triangles per piece, the array keeps its capacity between frames
+	this->vertices.resize(6 * __builtin_popcountll(occupied));
+	size_t vertex = 0;
+	float size = float(squareSize);
+	for (int color = 0; color < 2; color++) {
+		for (int type = 0; type < 6; type++) {
+			uint64_t currBoard = pieces[color][type] & occupied;
+			float u = float(type * PIECE_IMAGE_SIZE);
+			float v = float(color * PIECE_IMAGE_SIZE);
+			float s = float(PIECE_IMAGE_SIZE);
+			while (currBoard) {
+				int square = __builtin_ctzll(currBoard);
+				currBoard &= currBoard - 1;
+				int x = square % 8;
+				int y = 7 - square / 8;
+				if (flipped) {
+					x = 7 - x;
+					y = 7 - y;
+				}
+				sf::Vector2f topLeft(offset.x + x * size, offset.y + y * size);
+
+				sf::Vertex* quad = &this->vertices[vertex];
+				quad[0] = sf::Vertex{topLeft, sf::Color::White, {u, v}};
+				quad[1] = sf::Vertex{topLeft + sf::Vector2f(size, 0), sf::Color::White, {u + s, v}};
+				quad[2] = sf::Vertex{topLeft + sf::Vector2f(0, size), sf::Color::White, {u, v + s}};
+				quad[3] = quad[2];
+				quad[4] = quad[1];
+				quad[5] = sf::Vertex{topLeft + sf::Vector2f(size, size), sf::Color::White, {u + s, v + s}};
+				vertex += 6;
+			}
+		}
+	}
+
+	sf::RenderStates states;
+	states.texture = this->atlas;
+	window.draw(this->vertices, states);
+}
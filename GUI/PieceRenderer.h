@@ -0,0 +1,25 @@
+#pragma once
+#include "SFML/Graphics.hpp"
+#include "../Engine/Board.h"
+
+//Draws every piece on the board with one draw call. The twelve piece images are stitched into a
+//single atlas texture (one column per piece type, white on the top row) and each frame builds one
+//vertex array straight from the bitboards
+class PieceRenderer {
+public:
+	//Source size of the piece images
+	static constexpr int PIECE_IMAGE_SIZE = 60;
+
+	//The atlas is built from img/whitePawn.png ... img/blackKing.png once and shared by every renderer
+	PieceRenderer();
+
+	//skipSquare is left out (the piece being dragged), flipped draws the board from black's side
+	void draw(sf::RenderWindow& window, const Board& board, sf::Vector2i offset, int squareSize, int skipSquare, bool flipped);
+
+	const sf::Texture& getTexture() const { return *this->atlas; }
+	sf::IntRect getPieceRect(PieceType type, PieceColor color) const;
+
+private:
+	const sf::Texture* atlas;
+	sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+};
@@ -0,0 +1,28 @@
+#include "RenderScheduler.h"
+#include <algorithm>
+#include <thread>
+
+RenderScheduler::RenderScheduler(int maxFps) {
+	this->frameTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) / maxFps;
+	this->nextFrame = std::chrono::steady_clock::now();
+}
+
+void RenderScheduler::watch(uint64_t boardKey) {
+	if (boardKey != this->lastKey) {
+		this->lastKey = boardKey;
+		this->dirty = true;
+	}
+}
+
+void RenderScheduler::waitForNextFrame() {
+	std::this_thread::sleep_until(this->nextFrame);
+	//After a long frame (a bot search) start counting again instead of rushing to catch up
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	this->nextFrame = std::max(this->nextFrame + this->frameTime, now);
+}
+
+bool RenderScheduler::shouldRedraw() {
+	bool redraw = this->dirty;
+	this->dirty = false;
+	return redraw;
+}
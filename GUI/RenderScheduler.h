@@ -0,0 +1,28 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+//Decides which loop iterations actually redraw. Input, a new position, a network or search update
+//mark the frame dirty, every other iteration only polls events. The loop is paced to maxFps either way,
+//so an idle screen sleeps instead of pinning a core
+class RenderScheduler {
+public:
+	explicit RenderScheduler(int maxFps = 60);
+
+	void requestRedraw() { this->dirty = true; }
+
+	//Marks the frame dirty when the position changed since the last call
+	void watch(uint64_t boardKey);
+
+	//Sleeps until the next frame slot
+	void waitForNextFrame();
+
+	//True if this iteration has to draw, clears the request
+	bool shouldRedraw();
+
+private:
+	std::chrono::steady_clock::duration frameTime;
+	std::chrono::steady_clock::time_point nextFrame;
+	bool dirty = true;
+	uint64_t lastKey = 0;
+};
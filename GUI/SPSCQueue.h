@@ -0,0 +1,37 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//Lock free ring buffer for exactly one producer thread and one consumer thread.
+//Capacity must be a power of two, one slot is always left empty
+template <typename T, size_t Capacity>
+class SPSCQueue {
+	static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+	//Producer side, returns false when the queue is full
+	bool push(const T& value) {
+		size_t tail = this->tail.load(std::memory_order_relaxed);
+		size_t next = (tail + 1) & (Capacity - 1);
+		if (next == this->head.load(std::memory_order_acquire)) { return false; }
+		this->slots[tail] = value;
+		this->tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer side, returns false when the queue is empty
+	bool pop(T& value) {
+		size_t head = this->head.load(std::memory_order_relaxed);
+		if (head == this->tail.load(std::memory_order_acquire)) { return false; }
+		value = this->slots[head];
+		this->head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<T, Capacity> slots;
+	//Separate cache lines so the two threads don't fight over the indices
+	alignas(64) std::atomic<size_t> head{0};
+	alignas(64) std::atomic<size_t> tail{0};
+};
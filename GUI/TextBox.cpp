@@ -1,4 +1,5 @@
 #include "TextBox.h"
+#include "Assets.h"
 #include <iostream>
 
 TextBox::TextBox(sf::Vector2f pos, sf::Vector2f size, sf::Color color) {
@@ -7,7 +8,7 @@ TextBox::TextBox(sf::Vector2f pos, sf::Vector2f size, sf::Color color) {
 	this->color = color;
 	this->isActive = false;
 
-	this->font = sf::Font("..\\assets\\font\\arial.ttf");
+	this->font = &Assets::getFont("font/arial.ttf");
 }
 
 
@@ -28,7 +29,7 @@ void TextBox::drawSquare(sf::RenderWindow& window) {
 }
 
 void TextBox::drawText(sf::RenderWindow& window) {
-	sf::Text text(this->font, this->text, this->fontSize);
+	sf::Text text(*this->font, this->text, this->fontSize);
 	text.setCharacterSize(this->fontSize);
 	text.setFillColor(sf::Color(0, 0, 0));
 	
@@ -12,7 +12,7 @@ public:
 	sf::Color color;
 	std::string text = "";
 
-	sf::Font font;
+	const sf::Font* font;
 	int fontSize = 50;
 	bool isActive;
 
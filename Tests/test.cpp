@@ -0,0 +1,126 @@
+#include "../Engine/Board.h"
+#include "../Engine/MoveGenerator.h"
+#include "../Engine/Notation.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+
+namespace {
+
+//Perft positions, they cover castling, en passant, promotions and pins
+const char* POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+Board fromFEN(const char* fen) {
+    Board board;
+    board.parseFEN(fen);
+    return board;
+}
+
+bool isInCheck(Board& board) {
+    MoveGenerator generator(board);
+    return generator.isSquareAttacked(board.getKingPosition(board.whiteToMove ? white : black), board.whiteToMove ? black : white);
+}
+
+//Formats every legal move to SAN and UCI and parses both back, down to the given depth
+void checkRoundTrip(Board& board, int depth) {
+    Move list[MAX_MOVES];
+    int count = 0;
+    MoveGenerator generator(board);
+    generator.generateLegalMoves(moves, count, depth + 1);
+    std::copy(moves[depth + 1], moves[depth + 1] + count, list);
+
+    std::set<std::string> seen;
+    for (int i = 0; i < count; i++) {
+        const Move& move = list[i];
+        char san[NOTATION_BUFFER_SIZE], uci[NOTATION_BUFFER_SIZE];
+        int length = formatSAN(board, move, san);
+        formatUCI(move, uci);
+        EXPECT_TRUE(seen.insert(san).second) << "duplicate SAN " << san;
+
+        Move parsed;
+        ASSERT_TRUE(parseMove(board, san, parsed)) << san;
+        EXPECT_TRUE(parsed == move) << san;
+        ASSERT_TRUE(parseMove(board, uci, parsed)) << uci;
+        EXPECT_TRUE(parsed == move) << uci;
+
+        board.makeMove(move);
+        int replies = 0;
+        MoveGenerator after(board);
+        after.generateLegalMoves(moves, replies, 0);
+        char suffix = san[length - 1];
+        bool check = isInCheck(board);
+        EXPECT_EQ(suffix == '+', check && replies > 0) << san;
+        EXPECT_EQ(suffix == '#', check && replies == 0) << san;
+        if (depth > 0) {
+            checkRoundTrip(board, depth - 1);
+        }
+        board.unmakeMove(move);
+    }
+}
+
+}
+
+TEST(Notation, RoundTripsEveryLegalMove) {
+    for (const char* fen : POSITIONS) {
+        Board board = fromFEN(fen);
+        checkRoundTrip(board, 1);
+    }
+}
+
+TEST(Notation, PawnCaptureNeedsFileAndMarker) {
+    //1.e4 d5
+    Board board = fromFEN("rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2");
+    Move move;
+    EXPECT_FALSE(parseMove(board, "d5", move));
+    EXPECT_FALSE(parseMove(board, "ed5", move));
+    EXPECT_FALSE(parseMove(board, "xd5", move));
+    ASSERT_TRUE(parseMove(board, "exd5", move));
+    EXPECT_EQ(move.from, 28);
+    EXPECT_EQ(move.to, 35);
+}
+
+TEST(Notation, CaptureMarkerMustMatch) {
+    Board board = fromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    Move move;
+    EXPECT_FALSE(parseMove(board, "Nxf3", move));
+    EXPECT_FALSE(parseMove(board, "exe4", move));
+    EXPECT_TRUE(parseMove(board, "Nf3", move));
+    EXPECT_TRUE(parseMove(board, "e4", move));
+
+    //Kiwipete, the e5 knight can take on f7 or go quietly to d3
+    board = fromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    EXPECT_FALSE(parseMove(board, "Nf7", move));
+    EXPECT_TRUE(parseMove(board, "Nxf7", move));
+    EXPECT_FALSE(parseMove(board, "Nxd3", move));
+    EXPECT_TRUE(parseMove(board, "Nd3", move));
+}
+
+TEST(Notation, EnPassantIsACapture) {
+    Board board = fromFEN("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+    Move move;
+    EXPECT_FALSE(parseMove(board, "f6", move));
+    EXPECT_FALSE(parseMove(board, "ef6", move));
+    ASSERT_TRUE(parseMove(board, "exf6", move));
+    EXPECT_TRUE(move.isEnPassant);
+}
+
+TEST(Notation, MateSuffix) {
+    Board board = fromFEN("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+    Move move;
+    ASSERT_TRUE(parseMove(board, "Ra8", move));
+    char san[NOTATION_BUFFER_SIZE];
+    formatSAN(board, move, san);
+    EXPECT_STREQ(san, "Ra8#");
+
+    //Only en passant takes the checking pawn, so it is not mate
+    board = fromFEN("8/8/2Q5/k7/2p5/8/1P6/1Q5K w - - 0 1");
+    ASSERT_TRUE(parseMove(board, "b4", move));
+    formatSAN(board, move, san);
+    EXPECT_STREQ(san, "b4+");
+}
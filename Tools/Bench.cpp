@@ -0,0 +1,314 @@
+// Microbenchmarks for the engine's hot paths.
+//
+// Usage: chess_bench [-runs N] [-filter text] [-save baseline.json]
+//                    [-baseline baseline.json] [-tolerance percent]
+//
+// Every benchmark works over the same set of positions, from the opening to
+// pawn endgames, and is timed over several runs after a warmup. The report
+// gives the mean ns/op with its standard deviation and the fastest run.
+// With -baseline each benchmark's fastest run is compared against the saved
+// one, which is much less noisy than the mean, and the exit code is 1 if any
+// of them got slower by more than the tolerance (5% by default), so it can
+// gate merges. -save writes the current results
+// in the format -baseline reads.
+#include "../Engine/Board.h"
+#include "../Engine/Evaluator.h"
+#include "../Engine/MoveGenerator.h"
+#include "../Engine/TTEntry.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+constexpr int WARMUP_RUNS = 2;
+//Each run repeats the benchmark until at least this much time passed
+constexpr double MIN_RUN_SECONDS = 0.05;
+constexpr int TT_BENCH_KEYS = 1 << 16;
+
+static const char* BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "2r1kb1r/1Q2p1pp/2pBq3/1p3pR1/5P2/8/P4P1P/3R1K2 b - - 0 1",
+    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+};
+
+struct BenchResult {
+    std::string name;
+    double meanNs;
+    double stddevNs;
+    double minNs;
+};
+
+//Where the results of the benchmarked calls end up, so the compiler can't drop them
+static volatile uint64_t benchSink = 0;
+
+//Runs one batch and returns how many operations it did
+using BenchFunction = std::function<uint64_t(uint64_t& sink)>;
+
+static BenchResult measure(const std::string& name, const BenchFunction& batch, int runs) {
+    uint64_t sink = 0;
+    for (int i = 0; i < WARMUP_RUNS; i++) {
+        batch(sink);
+    }
+
+    std::vector<double> samples;
+    for (int run = 0; run < runs; run++) {
+        uint64_t ops = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0;
+        do {
+            ops += batch(sink);
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < MIN_RUN_SECONDS);
+        samples.push_back(seconds * 1e9 / ops);
+    }
+
+    double mean = 0;
+    for (double sample : samples) {
+        mean += sample;
+    }
+    mean /= samples.size();
+    double variance = 0;
+    for (double sample : samples) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    variance /= std::max<size_t>(1, samples.size() - 1);
+
+    benchSink = sink;
+    return {name, mean, std::sqrt(variance), *std::min_element(samples.begin(), samples.end())};
+}
+
+//Baselines are written by saveBaseline, one benchmark per line, so they are read line by line too
+static bool loadBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t nameStart = line.find("{\"name\":\"");
+        size_t minStart = line.find("\"minNs\":");
+        if (nameStart == std::string::npos || minStart == std::string::npos) {
+            continue;
+        }
+        nameStart += 9;
+        std::string name = line.substr(nameStart, line.find('"', nameStart) - nameStart);
+        baseline[name] = std::strtod(line.c_str() + minStart + 8, nullptr);
+    }
+    return true;
+}
+
+static bool saveBaseline(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "{\"benchmarks\":[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        out << "{\"name\":\"" << result.name << "\",\"meanNs\":" << result.meanNs
+            << ",\"stddevNs\":" << result.stddevNs << ",\"minNs\":" << result.minNs << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]}\n";
+    return bool(out);
+}
+
+int main(int argc, char** argv) {
+    int runs = 10;
+    std::string filter;
+    std::string savePath;
+    std::string baselinePath;
+    double tolerance = 5.0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "-runs") {
+            runs = std::max(2, std::stoi(argv[++i]));
+        }
+        else if (i + 1 < argc && arg == "-filter") {
+            filter = argv[++i];
+        }
+        else if (i + 1 < argc && arg == "-save") {
+            savePath = argv[++i];
+        }
+        else if (i + 1 < argc && arg == "-baseline") {
+            baselinePath = argv[++i];
+        }
+        else if (i + 1 < argc && arg == "-tolerance") {
+            tolerance = std::stod(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: chess_bench [-runs N] [-filter text] [-save baseline.json] [-baseline baseline.json] [-tolerance percent]" << std::endl;
+            return 1;
+        }
+    }
+
+    clearTT();
+
+    std::vector<std::string> fens(std::begin(BENCH_POSITIONS), std::end(BENCH_POSITIONS));
+    std::vector<Board> boards(fens.size());
+    std::vector<std::vector<Move>> legalMoves(fens.size());
+    static Move moveBuffer[1][MAX_MOVES];
+    for (size_t i = 0; i < fens.size(); i++) {
+        boards[i].parseFEN(fens[i]);
+        int moveCount = 0;
+        MoveGenerator gen(boards[i]);
+        gen.generateLegalMoves(moveBuffer, moveCount, 0);
+        legalMoves[i].assign(moveBuffer[0], moveBuffer[0] + moveCount);
+    }
+
+    //Pseudo random keys spread over the whole table, the same ones on every run
+    std::vector<uint64_t> ttKeys(TT_BENCH_KEYS);
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t& key : ttKeys) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        key = seed;
+    }
+
+    std::vector<std::pair<std::string, BenchFunction>> benchmarks = {
+        {"makeUnmakeMove", [&](uint64_t& sink) {
+            uint64_t ops = 0;
+            for (size_t i = 0; i < boards.size(); i++) {
+                for (const Move& move : legalMoves[i]) {
+                    boards[i].makeMove(move);
+                    sink += boards[i].zobristHash;
+                    boards[i].unmakeMove(move);
+                }
+                ops += legalMoves[i].size();
+            }
+            return ops;
+        }},
+        {"generateLegalMoves", [&](uint64_t& sink) {
+            for (Board& board : boards) {
+                int moveCount = 0;
+                MoveGenerator gen(board);
+                gen.generateLegalMoves(moveBuffer, moveCount, 0);
+                sink += moveCount;
+            }
+            return uint64_t(boards.size());
+        }},
+        {"isSquareAttacked", [&](uint64_t& sink) {
+            for (Board& board : boards) {
+                MoveGenerator gen(board);
+                for (int square = 0; square < 64; square++) {
+                    sink += gen.isSquareAttacked(square, white) + gen.isSquareAttacked(square, black);
+                }
+            }
+            return uint64_t(boards.size() * 128);
+        }},
+        {"evaluate", [&](uint64_t& sink) {
+            for (const Board& board : boards) {
+                sink += Evaluator::evaluate(board);
+            }
+            return uint64_t(boards.size());
+        }},
+        {"storeTT", [&](uint64_t& sink) {
+            for (size_t i = 0; i < ttKeys.size(); i++) {
+                storeTT(ttKeys[i], int(i & 15), int(i), EXACT, uint16_t(i));
+            }
+            sink += TT[ttKeys[0] & (TTSIZE - 1)].data.load(std::memory_order_relaxed);
+            return uint64_t(ttKeys.size());
+        }},
+        {"probeTT", [&](uint64_t& sink) {
+            TTEntry entry;
+            for (uint64_t key : ttKeys) {
+                sink += probeTT(key, entry) + entry.score;
+            }
+            return uint64_t(ttKeys.size());
+        }},
+        {"parseFEN", [&](uint64_t& sink) {
+            Board board;
+            for (const std::string& fen : fens) {
+                board.parseFEN(fen);
+                sink += board.zobristHash;
+            }
+            return uint64_t(fens.size());
+        }},
+    };
+
+    //Slider lookups once per backend the CPU can run, everything else uses the one picked at startup
+    SliderBackend defaultBackend = MoveGenerator::getSliderBackend();
+    std::vector<std::pair<SliderBackend, std::string>> backends = {{SliderBackend::Magic, "magic"}};
+    if (MoveGenerator::cpuHasBmi2()) {
+        backends.push_back({SliderBackend::Pext, "pext"});
+    }
+    for (const auto& [backend, backendName] : backends) {
+        benchmarks.push_back({"getRookAttacks/" + backendName, [&, backend = backend](uint64_t& sink) {
+            MoveGenerator::setSliderBackend(backend);
+            for (const Board& board : boards) {
+                for (int square = 0; square < 64; square++) {
+                    sink += MoveGenerator::getRookAttacks(square, board.allPieces);
+                }
+            }
+            MoveGenerator::setSliderBackend(defaultBackend);
+            return uint64_t(boards.size() * 64);
+        }});
+        benchmarks.push_back({"getBishopAttacks/" + backendName, [&, backend = backend](uint64_t& sink) {
+            MoveGenerator::setSliderBackend(backend);
+            for (const Board& board : boards) {
+                for (int square = 0; square < 64; square++) {
+                    sink += MoveGenerator::getBishopAttacks(square, board.allPieces);
+                }
+            }
+            MoveGenerator::setSliderBackend(defaultBackend);
+            return uint64_t(boards.size() * 64);
+        }});
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty() && !loadBaseline(baselinePath, baseline)) {
+        std::cerr << "Could not read " << baselinePath << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    std::printf("%-24s %12s %10s %12s %10s\n", "benchmark", "ns/op", "stddev", "min ns/op", "change");
+    for (const auto& [name, batch] : benchmarks) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            continue;
+        }
+        BenchResult result = measure(name, batch, runs);
+        results.push_back(result);
+
+        std::string change = "-";
+        auto base = baseline.find(name);
+        if (base != baseline.end() && base->second > 0) {
+            double percent = (result.minNs / base->second - 1.0) * 100.0;
+            char text[32];
+            std::snprintf(text, sizeof(text), "%+.1f%%%s", percent, percent > tolerance ? " !" : "");
+            change = text;
+            regressions += percent > tolerance;
+        }
+        std::printf("%-24s %12.2f %10.2f %12.2f %10s\n", name.c_str(), result.meanNs, result.stddevNs, result.minNs, change.c_str());
+    }
+
+    if (!savePath.empty()) {
+        if (!saveBaseline(savePath, results)) {
+            std::cerr << "Could not write " << savePath << std::endl;
+            return 1;
+        }
+        std::cout << "Saved baseline to " << savePath << std::endl;
+    }
+    if (regressions > 0) {
+        std::cout << regressions << " benchmark(s) slower than the baseline by more than " << tolerance << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
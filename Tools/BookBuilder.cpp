@@ -0,0 +1,499 @@
+// Compiles game collections into the binary opening book read by OpeningBook.
+//
+// Usage: book_builder <book.bin> <games>... [-plies N] [-threads N]
+//
+// Inputs are picked by extension:
+//   .pgn  standard PGN, the result comes from the Result tag or the movetext
+//   .csv  needs a "moves_list" column holding a Python list of SAN moves
+//         (['e4', 'e5', ...]), and an optional "result" column
+//   other one game per line as SAN moves separated by spaces, optionally
+//         with move numbers ("1.e4") and a trailing result (Games.txt)
+//
+// The main thread streams each file in large chunks cut at game boundaries.
+// Worker threads replay the games through the engine and keep their own
+// partial book, and the sorted partial books are merged at the end. Each book
+// move is weighted by how often it was played and scored by how the side
+// that played it did in those games.
+#include "../Engine/Board.h"
+#include "../Engine/MoveGenerator.h"
+#include "../Engine/Notation.h"
+#include "../Engine/OpeningBook.h"
+#include "../Engine/Search.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr size_t CHUNK_BYTES = 8 << 20;
+constexpr size_t FOLD_RECORDS = 1 << 22;
+//Text held back waiting for a game boundary before it is cut at a line anyway
+constexpr size_t MAX_PENDING_BYTES = 4 * CHUNK_BYTES;
+
+enum InputFormat { LINES, PGN, CSV };
+
+//Counts for one (position, move) pair before they are folded into a BookEntry
+struct MoveStats {
+    uint64_t key;
+    uint16_t move;
+    uint32_t played;
+    uint32_t scored;   // games with a known result
+    uint32_t points;   // half points won by the side that played the move
+};
+
+struct Chunk {
+    InputFormat format;
+    std::string text;
+    int movesColumn;   // CSV only
+    int resultColumn;  // CSV only, -1 if the file has none
+};
+
+//Bounded so the reader can't run arbitrarily far ahead of the workers
+class ChunkQueue {
+    public:
+        explicit ChunkQueue(size_t capacity) : capacity(capacity) {}
+
+        void push(Chunk chunk) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [&] { return chunks.size() < capacity; });
+            chunks.push_back(std::move(chunk));
+            notEmpty.notify_one();
+        }
+
+        //Returns false once the queue is closed and drained
+        bool pop(Chunk& chunk) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [&] { return !chunks.empty() || closed; });
+            if (chunks.empty()) {
+                return false;
+            }
+            chunk = std::move(chunks.front());
+            chunks.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            notEmpty.notify_all();
+        }
+
+    private:
+        size_t capacity;
+        bool closed = false;
+        std::deque<Chunk> chunks;
+        std::mutex mutex;
+        std::condition_variable notEmpty, notFull;
+};
+
+//White's result in half points, -1 if the token isn't a finished result
+int parseResult(const std::string& token) {
+    if (token == "1-0") return 2;
+    if (token == "1/2-1/2") return 1;
+    if (token == "0-1") return 0;
+    return -1;
+}
+
+bool isResult(const std::string& token) {
+    return parseResult(token) != -1 || token == "*";
+}
+
+//Strips move numbers and annotation glyphs, returns false if nothing of a move is left
+bool cleanMoveToken(std::string& token) {
+    size_t start = 0;
+    while (start < token.size() && (std::isdigit((unsigned char)token[start]) || token[start] == '.')) {
+        start++;
+    }
+    token.erase(0, start);
+    while (!token.empty() && (token.back() == '!' || token.back() == '?')) {
+        token.pop_back();
+    }
+    return !token.empty() && token[0] != '$';
+}
+
+//Replays one game and records a (position, move) pair for each of its first plies
+void addGame(const std::vector<std::string>& sanMoves, int result, int maxPlies, std::vector<MoveStats>& stats) {
+    Board board = Board();
+    board.setStartingPosition();
+    for (int ply = 0; ply < maxPlies && ply < int(sanMoves.size()); ply++) {
+        Move move;
+        if (!parseMove(board, sanMoves[ply], move)) {
+            return; // the rest of the game can't be trusted
+        }
+        int points = result == -1 ? 0 : board.whiteToMove ? result : 2 - result;
+        stats.push_back({board.zobristHash, move.pack(), 1, result == -1 ? 0u : 1u, uint32_t(points)});
+        board.makeMove(move);
+    }
+}
+
+//Games.txt style, one game per line
+int parseLines(const std::string& text, int maxPlies, std::vector<MoveStats>& stats) {
+    std::istringstream lines(text);
+    std::string line, token;
+    std::vector<std::string> sanMoves;
+    int games = 0;
+    while (std::getline(lines, line)) {
+        std::istringstream tokens(line);
+        sanMoves.clear();
+        int result = -1;
+        while (tokens >> token) {
+            if (isResult(token)) {
+                result = parseResult(token);
+                break;
+            }
+            if (cleanMoveToken(token)) {
+                sanMoves.push_back(token);
+            }
+        }
+        if (!sanMoves.empty()) {
+            addGame(sanMoves, result, maxPlies, stats);
+            games++;
+        }
+    }
+    return games;
+}
+
+int parsePGN(const std::string& text, int maxPlies, std::vector<MoveStats>& stats) {
+    std::vector<std::string> sanMoves;
+    int result = -1;
+    int games = 0;
+    auto finishGame = [&] {
+        if (!sanMoves.empty()) {
+            addGame(sanMoves, result, maxPlies, stats);
+            games++;
+        }
+        sanMoves.clear();
+        result = -1;
+    };
+
+    size_t i = 0;
+    int variationDepth = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c == '[' && variationDepth == 0) {
+            //A tag after movetext starts the next game
+            size_t end = text.find(']', i);
+            if (end == std::string::npos) break;
+            if (!sanMoves.empty()) finishGame();
+            std::string tag = text.substr(i, end - i);
+            if (tag.compare(0, 8, "[Result ") == 0) {
+                size_t quote = tag.find('"');
+                if (quote != std::string::npos) {
+                    result = parseResult(tag.substr(quote + 1, tag.find('"', quote + 1) - quote - 1));
+                }
+            }
+            i = end + 1;
+        }
+        else if (c == '{') {
+            size_t end = text.find('}', i);
+            i = end == std::string::npos ? text.size() : end + 1;
+        }
+        else if (c == ';') {
+            size_t end = text.find('\n', i);
+            i = end == std::string::npos ? text.size() : end + 1;
+        }
+        else if (c == '(') {
+            variationDepth++;
+            i++;
+        }
+        else if (c == ')') {
+            variationDepth = std::max(0, variationDepth - 1);
+            i++;
+        }
+        else if (std::isspace((unsigned char)c)) {
+            i++;
+        }
+        else {
+            size_t end = i;
+            while (end < text.size() && !std::isspace((unsigned char)text[end]) && std::strchr("{}()[];", text[end]) == nullptr) {
+                end++;
+            }
+            std::string token = text.substr(i, end - i);
+            i = end;
+            if (variationDepth > 0) continue;
+            if (isResult(token)) {
+                if (result == -1) result = parseResult(token);
+                finishGame();
+            }
+            else if (cleanMoveToken(token)) {
+                sanMoves.push_back(token);
+            }
+        }
+    }
+    finishGame();
+    return games;
+}
+
+//Splits one CSV record, honouring double quotes around fields with commas
+void splitCSVLine(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '"') {
+            if (quoted && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                i++;
+            }
+            else {
+                quoted = !quoted;
+            }
+        }
+        else if (c == ',' && !quoted) {
+            fields.push_back(field);
+            field.clear();
+        }
+        else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+}
+
+int parseCSV(const Chunk& chunk, int maxPlies, std::vector<MoveStats>& stats) {
+    std::istringstream lines(chunk.text);
+    std::string line;
+    std::vector<std::string> fields, sanMoves;
+    int games = 0;
+    while (std::getline(lines, line)) {
+        splitCSVLine(line, fields);
+        if (int(fields.size()) <= chunk.movesColumn) continue;
+
+        //['e4', 'e5', ...]
+        sanMoves.clear();
+        std::string token;
+        for (char c : fields[chunk.movesColumn]) {
+            if (c == '[' || c == ']' || c == '\'' || c == '"' || c == ' ') continue;
+            if (c == ',') {
+                if (!token.empty()) sanMoves.push_back(token);
+                token.clear();
+            }
+            else {
+                token += c;
+            }
+        }
+        if (!token.empty()) sanMoves.push_back(token);
+
+        int result = chunk.resultColumn >= 0 && chunk.resultColumn < int(fields.size()) ? parseResult(fields[chunk.resultColumn]) : -1;
+        if (!sanMoves.empty()) {
+            addGame(sanMoves, result, maxPlies, stats);
+            games++;
+        }
+    }
+    return games;
+}
+
+bool statsBefore(const MoveStats& a, const MoveStats& b) {
+    return a.key != b.key ? a.key < b.key : a.move < b.move;
+}
+
+//Sorts by key and folds duplicate (position, move) pairs together.
+//The first `sorted` records are sorted already, only the rest is sorted and then merged in
+void foldStats(std::vector<MoveStats>& stats, size_t sorted = 0) {
+    std::sort(stats.begin() + sorted, stats.end(), statsBefore);
+    std::inplace_merge(stats.begin(), stats.begin() + sorted, stats.end(), statsBefore);
+    size_t out = 0;
+    for (size_t i = 0; i < stats.size(); i++) {
+        if (out > 0 && stats[out - 1].key == stats[i].key && stats[out - 1].move == stats[i].move) {
+            stats[out - 1].played += stats[i].played;
+            stats[out - 1].scored += stats[i].scored;
+            stats[out - 1].points += stats[i].points;
+            continue;
+        }
+        stats[out++] = stats[i];
+    }
+    stats.resize(out);
+}
+
+//Folded stats to book entries
+std::vector<BookEntry> toEntries(const std::vector<MoveStats>& stats) {
+    //Weights only matter relative to the other moves of the same position, so each position is scaled on its own
+    std::vector<BookEntry> entries(stats.size());
+    for (size_t first = 0; first < stats.size();) {
+        size_t last = first;
+        uint32_t maxPlayed = 0;
+        while (last < stats.size() && stats[last].key == stats[first].key) {
+            maxPlayed = std::max(maxPlayed, stats[last++].played);
+        }
+        for (size_t i = first; i < last; i++) {
+            uint64_t weight = maxPlayed <= 0xFFFF ? stats[i].played : uint64_t(stats[i].played) * 0xFFFF / maxPlayed;
+            //Moves without a known result count as even
+            uint64_t score = stats[i].scored == 0 ? 0x8000 : uint64_t(stats[i].points) * 0xFFFF / (2 * uint64_t(stats[i].scored));
+            entries[i] = {stats[i].key, stats[i].move, uint16_t(std::max<uint64_t>(weight, 1)), uint16_t(score), 0};
+        }
+        first = last;
+    }
+    return entries;
+}
+
+void buildWorker(ChunkQueue& queue, int maxPlies, std::vector<MoveStats>& stats, std::atomic<uint64_t>& games) {
+    Chunk chunk;
+    size_t folded = 0;
+    while (queue.pop(chunk)) {
+        int parsed = chunk.format == PGN ? parsePGN(chunk.text, maxPlies, stats)
+            : chunk.format == CSV ? parseCSV(chunk, maxPlies, stats)
+            : parseLines(chunk.text, maxPlies, stats);
+        games += parsed;
+        //Opening positions repeat a lot, folding early keeps the partial book small.
+        //Counting only the records added since the last fold keeps this from running on every chunk
+        if (stats.size() - folded >= FOLD_RECORDS) {
+            foldStats(stats, folded);
+            folded = stats.size();
+        }
+    }
+    foldStats(stats, folded);
+}
+
+//Finds the column index of name in a CSV header, -1 if missing
+int findColumn(const std::string& header, const std::string& name) {
+    std::vector<std::string> fields;
+    splitCSVLine(header, fields);
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i] == name) return int(i);
+    }
+    return -1;
+}
+
+//Start of the last line in text that opens a PGN game: a tag line right after movetext or a blank line.
+//Returns npos if there is none
+size_t lastGameStart(const std::string& text) {
+    for (size_t at = text.rfind("\n["); at != std::string::npos && at > 0; at = text.rfind("\n[", at - 1)) {
+        size_t previous = text.rfind('\n', at - 1);
+        previous = previous == std::string::npos ? 0 : previous + 1;
+        if (text[previous] != '[') {
+            return at;
+        }
+    }
+    return std::string::npos;
+}
+
+//Streams a file into the queue in chunks that don't split a game
+bool readInput(const std::string& path, ChunkQueue& queue) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Could not open " << path << std::endl;
+        return false;
+    }
+    std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    Chunk prototype{extension == ".pgn" ? PGN : extension == ".csv" ? CSV : LINES, "", -1, -1};
+
+    if (prototype.format == CSV) {
+        std::string header;
+        std::getline(in, header);
+        if (!header.empty() && header.back() == '\r') header.pop_back();
+        prototype.movesColumn = findColumn(header, "moves_list");
+        prototype.resultColumn = findColumn(header, "result");
+        if (prototype.movesColumn == -1) {
+            std::cerr << path << " has no moves_list column" << std::endl;
+            return false;
+        }
+    }
+
+    std::string pending;
+    std::vector<char> buffer(CHUNK_BYTES);
+    while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+        pending.append(buffer.data(), in.gcount());
+
+        //PGN games start at a tag line after movetext, the other formats at any line.
+        //A PGN without tag lines would never cut, so past the bound it falls back to lines
+        size_t cut = prototype.format == PGN ? lastGameStart(pending) : pending.rfind('\n');
+        if ((cut == std::string::npos || cut == 0) && pending.size() > MAX_PENDING_BYTES) {
+            cut = pending.rfind('\n');
+        }
+        if (cut == std::string::npos || cut == 0) continue;
+
+        Chunk chunk = prototype;
+        chunk.text = pending.substr(0, cut + 1);
+        pending.erase(0, cut + 1);
+        queue.push(std::move(chunk));
+    }
+    if (!pending.empty()) {
+        Chunk chunk = prototype;
+        chunk.text = std::move(pending);
+        queue.push(std::move(chunk));
+    }
+    return true;
+}
+
+bool writeBook(const std::string& path, const std::vector<BookEntry>& entries) {
+    Board start = Board();
+    start.setStartingPosition();
+    BookHeader header;
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.entryCount = uint32_t(entries.size());
+    header.startKey = start.zobristHash;
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(entries.data(), sizeof(BookEntry), entries.size(), file) == entries.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+int main(int argc, char** argv) {
+    std::string outputPath;
+    std::vector<std::string> inputs;
+    int maxPlies = 16;
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-plies" && i + 1 < argc) maxPlies = std::stoi(argv[++i]);
+        else if (arg == "-threads" && i + 1 < argc) threadCount = std::max(1, std::stoi(argv[++i]));
+        else if (outputPath.empty()) outputPath = arg;
+        else inputs.push_back(arg);
+    }
+    if (outputPath.empty() || inputs.empty()) {
+        std::cerr << "Usage: book_builder <book.bin> <games.pgn|games.csv|games.txt>... [-plies N] [-threads N]" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ChunkQueue queue(2 * threadCount);
+    std::vector<std::vector<MoveStats>> partials(threadCount);
+    std::atomic<uint64_t> games{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back(buildWorker, std::ref(queue), maxPlies, std::ref(partials[t]), std::ref(games));
+    }
+
+    bool ok = true;
+    for (const std::string& input : inputs) {
+        ok = readInput(input, queue) && ok;
+    }
+    queue.close();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    //Every partial book is sorted already, merge them pairwise and fold across threads
+    std::vector<MoveStats> stats;
+    for (std::vector<MoveStats>& partial : partials) {
+        size_t middle = stats.size();
+        stats.insert(stats.end(), partial.begin(), partial.end());
+        partial = std::vector<MoveStats>();
+        std::inplace_merge(stats.begin(), stats.begin() + middle, stats.end(), statsBefore);
+    }
+    foldStats(stats, stats.size());
+
+    std::vector<BookEntry> entries = toEntries(stats);
+    if (!writeBook(outputPath, entries)) {
+        std::cerr << "Could not write " << outputPath << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << entries.size() << " entries from " << games << " games to " << outputPath << " in "
+        << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+// Headless self-play data generation.
+//
+// Usage: datagen <output.bin> [games] [depth] [nodes] [threads] [seed]
+//
+// Every thread plays its own games from a short random opening and keeps
+// the quiet positions it searched, labeled with the search score and the
+// final result. Records are appended to the output in PackedPosition form.
+#include "../Engine/Board.h"
+#include "../Engine/MoveGenerator.h"
+#include "../Engine/Search.h"
+#include "PackedPosition.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+constexpr int RANDOM_OPENING_PLIES = 8;
+constexpr int MAX_GAME_PLIES = 400;
+constexpr int MATE_THRESHOLD = 90000;
+constexpr size_t FLUSH_RECORDS = 1 << 14;
+
+struct DatagenSettings {
+    int games;
+    int depth;
+    uint64_t nodes;
+    uint64_t seed;
+};
+
+struct DatagenOutput {
+    std::FILE* file;
+    std::mutex mutex;
+    std::atomic<int> gamesStarted{0};
+    std::atomic<int> gamesFinished{0};
+    std::atomic<uint64_t> positionsWritten{0};
+};
+
+bool isInCheck(Board& board) {
+    MoveGenerator gen(board);
+    PieceColor toMove = board.whiteToMove ? white : black;
+    return gen.isSquareAttacked(board.getKingPosition(toMove), toMove == white ? black : white);
+}
+
+//Plays random legal moves, returns false if the game ended on the way
+bool playRandomOpening(Board& board, std::mt19937_64& rng) {
+    for (int ply = 0; ply < RANDOM_OPENING_PLIES; ply++) {
+        MoveGenerator gen(board);
+        int moveCount = 0;
+        gen.generateLegalMoves(moves, moveCount, 0);
+        if (moveCount == 0) {
+            return false;
+        }
+        board.makeMove(moves[0][rng() % moveCount]);
+    }
+    return true;
+}
+
+void flush(DatagenOutput& output, std::vector<PackedPosition>& records) {
+    std::lock_guard<std::mutex> lock(output.mutex);
+    std::fwrite(records.data(), sizeof(PackedPosition), records.size(), output.file);
+    output.positionsWritten += records.size();
+    records.clear();
+}
+
+void playGames(const DatagenSettings& settings, DatagenOutput& output, int threadIndex) {
+    std::mt19937_64 rng(settings.seed + threadIndex);
+    std::vector<PackedPosition> records;
+    std::vector<PackedPosition> gameRecords;
+    Search search = Search();
+    search.verbose = false;
+
+    while (output.gamesStarted.fetch_add(1) < settings.games) {
+        Board board = Board();
+        board.setStartingPosition();
+        while (!playRandomOpening(board, rng)) {
+            board = Board();
+            board.setStartingPosition();
+        }
+
+        gameRecords.clear();
+        uint8_t result = 1;
+        for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+            MoveGenerator gen(board);
+            int moveCount = 0;
+            gen.generateLegalMoves(moves, moveCount, 0);
+            bool inCheck = isInCheck(board);
+            if (moveCount == 0) {
+                if (inCheck) {
+                    result = board.whiteToMove ? 0 : 2;
+                }
+                break;
+            }
+            if (board.halfMoveClock >= 100 || board.isRepetition(2)) {
+                break;
+            }
+
+            Move bestMove = search.findBestMoveLimited(board, settings.depth, settings.nodes);
+            int score = search.lastScore;
+
+            //Only quiet positions are useful labels for the evaluation
+            bool quiet = !inCheck && bestMove.pieceEatenType == None && bestMove.promotionPiece == None;
+            if (quiet && std::abs(score) < MATE_THRESHOLD) {
+                gameRecords.push_back(packPosition(board, score));
+            }
+            board.makeMove(bestMove);
+        }
+
+        for (PackedPosition& record : gameRecords) {
+            record.result = result;
+        }
+        records.insert(records.end(), gameRecords.begin(), gameRecords.end());
+        if (records.size() >= FLUSH_RECORDS) {
+            flush(output, records);
+        }
+        output.gamesFinished++;
+    }
+    flush(output, records);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: datagen <output.bin> [games] [depth] [nodes] [threads] [seed]" << std::endl;
+        return 1;
+    }
+
+    DatagenSettings settings;
+    settings.games = argc > 2 ? std::stoi(argv[2]) : 1000;
+    settings.depth = argc > 3 ? std::stoi(argv[3]) : 6;
+    settings.nodes = argc > 4 ? std::stoull(argv[4]) : 0;
+    int threadCount = argc > 5 ? std::stoi(argv[5]) : std::max(1u, std::thread::hardware_concurrency());
+    settings.seed = argc > 6 ? std::stoull(argv[6]) : std::random_device()();
+
+    clearTT();
+
+    DatagenOutput output;
+    output.file = std::fopen(argv[1], "ab");
+    if (output.file == nullptr) {
+        std::cerr << "Could not open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back(playGames, std::cref(settings), std::ref(output), t);
+    }
+
+    //Progress report from the main thread while the workers play
+    for (int second = 1; output.gamesFinished < settings.games; second++) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (second % 10 != 0) {
+            continue;
+        }
+        double hours = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 3600.0;
+        std::cout << output.gamesFinished << "/" << settings.games << " games, "
+            << output.positionsWritten << " positions, "
+            << int(output.gamesFinished / hours) << " games/hour" << std::endl;
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    std::fclose(output.file);
+    std::cout << "Wrote " << output.positionsWritten << " positions to " << argv[1] << std::endl;
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Compact 32 byte training record written by datagen.
+// Files are a plain array of these records in little endian order.
+#pragma once
+#include "../Engine/Board.h"
+#include <algorithm>
+#include <cstdint>
+
+struct PackedPosition {
+    uint64_t occupancy;        // set bits are occupied squares, a1 = bit 0
+    uint8_t pieces[16];        // one nibble per occupied square in bit order: piece type | color << 3
+    uint8_t sideAndEnPassant;  // bit 7 set when black is to move, low bits: en passant square or 64 for none
+    uint8_t halfMoveClock;
+    uint16_t fullMoveNumber;
+    int16_t score;             // search score in centipawns, white's point of view
+    uint8_t result;            // 0 = black won, 1 = draw, 2 = white won
+    uint8_t castlingRights;    // 1 = WK, 2 = WQ, 4 = BK, 8 = BQ
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+inline PackedPosition packPosition(const Board& board, int score) {
+    PackedPosition packed = {};
+    packed.occupancy = board.getCombinedBoard(white) | board.getCombinedBoard(black);
+
+    uint64_t occupied = packed.occupancy;
+    int index = 0;
+    while (occupied) {
+        int square = __builtin_ctzll(occupied);
+        occupied &= occupied - 1;
+        std::pair<PieceType, PieceColor> piece = board.getPieceTypeAtBit(square);
+        uint8_t nibble = uint8_t(piece.first | (piece.second << 3));
+        packed.pieces[index / 2] |= (index % 2 == 0) ? nibble : uint8_t(nibble << 4);
+        index++;
+    }
+
+    packed.sideAndEnPassant = uint8_t((board.whiteToMove ? 0 : 0x80) | (board.enPassantSquare == -1 ? 64 : board.enPassantSquare));
+    packed.halfMoveClock = uint8_t(std::min(board.halfMoveClock, 255));
+    packed.fullMoveNumber = uint16_t(board.fullMoveNumber);
+    packed.score = int16_t(std::max(-32000, std::min(32000, score)));
+    packed.result = 1;
+    packed.castlingRights = uint8_t(board.castlingRights);
+    return packed;
+}
@@ -0,0 +1,264 @@
+// Texel tuner for the evaluation weights.
+//
+// Usage: tuner <dataset.csv|dataset.epd> [output header] [epochs] [threads]
+//
+// CSV datasets need a "fen" and a "result" column. EPD datasets hold one
+// position per line, followed by the result as c9 "1-0"; or [1.0].
+// Results are always from white's point of view.
+#include "../Engine/Board.h"
+#include "../Engine/Evaluator.h"
+#include "csv.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TunerPosition {
+    uint32_t termOffset;
+    uint8_t termCount;
+    float result;
+};
+
+struct Dataset {
+    std::vector<TunerPosition> positions;
+    std::vector<EvalTerm> terms;
+};
+
+//Returns -1 if the result could not be read
+float parseResult(std::string result) {
+    result.erase(std::remove_if(result.begin(), result.end(), [](unsigned char c) {
+        return c == '"' || c == ';' || c == '[' || c == ']' || std::isspace(c);
+    }), result.end());
+
+    if (result == "1-0") return 1.0f;
+    if (result == "0-1") return 0.0f;
+    if (result == "1/2-1/2") return 0.5f;
+    try {
+        float value = std::stof(result);
+        if (value >= 0.0f && value <= 1.0f) return value;
+    }
+    catch (const std::exception&) {}
+    return -1.0f;
+}
+
+void addPosition(Dataset& data, const Board& emptyBoard, const std::string& fen, float result) {
+    if (result < 0.0f) return;
+
+    Board board = emptyBoard;
+    board.parseFEN(fen);
+
+    EvalTerm terms[MAX_EVAL_TERMS];
+    int termCount = Evaluator::extractTerms(board, terms);
+
+    data.positions.push_back({uint32_t(data.terms.size()), uint8_t(termCount), result});
+    data.terms.insert(data.terms.end(), terms, terms + termCount);
+}
+
+void loadCSV(Dataset& data, const std::string& path) {
+    Board emptyBoard = Board();
+    csv::CSVReader reader(path);
+    for (csv::CSVRow& row : reader) {
+        addPosition(data, emptyBoard, row["fen"].get<std::string>(), parseResult(row["result"].get<std::string>()));
+    }
+}
+
+void loadEPD(Dataset& data, const std::string& path) {
+    Board emptyBoard = Board();
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t marker = line.find("c9");
+        if (marker == std::string::npos) marker = line.find('[');
+        if (marker == std::string::npos) continue;
+
+        std::string result = line.substr(line[marker] == '[' ? marker : marker + 2);
+        addPosition(data, emptyBoard, line.substr(0, marker), parseResult(result));
+    }
+}
+
+inline double evaluateTerms(const Dataset& data, const TunerPosition& position, const double* params) {
+    const EvalTerm* terms = &data.terms[position.termOffset];
+    double score = 0.0;
+    for (int i = 0; i < position.termCount; i++) {
+        score += params[terms[i].index] * terms[i].coefficient;
+    }
+    return score;
+}
+
+inline double sigmoid(double score, double K) {
+    return 1.0 / (1.0 + std::pow(10.0, -K * score / 400.0));
+}
+
+//Runs work(begin, end, threadIndex) over the positions split across threads
+template <typename Work>
+void parallelFor(size_t count, int threadCount, Work work) {
+    std::vector<std::thread> threads;
+    size_t chunk = (count + threadCount - 1) / threadCount;
+    for (int t = 0; t < threadCount; t++) {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        threads.emplace_back(work, begin, end, t);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+double meanSquaredError(const Dataset& data, const double* params, double K, int threadCount) {
+    std::vector<double> partial(threadCount, 0.0);
+    parallelFor(data.positions.size(), threadCount, [&](size_t begin, size_t end, int t) {
+        double error = 0.0;
+        for (size_t i = begin; i < end; i++) {
+            double diff = data.positions[i].result - sigmoid(evaluateTerms(data, data.positions[i], params), K);
+            error += diff * diff;
+        }
+        partial[t] = error;
+    });
+
+    double total = 0.0;
+    for (double error : partial) total += error;
+    return total / data.positions.size();
+}
+
+//Golden section search for the scaling constant that best fits the current weights
+double findK(const Dataset& data, const double* params, int threadCount) {
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double low = 0.1, high = 3.0;
+    for (int i = 0; i < 30; i++) {
+        double left = high - ratio * (high - low);
+        double right = low + ratio * (high - low);
+        if (meanSquaredError(data, params, left, threadCount) < meanSquaredError(data, params, right, threadCount)) {
+            high = right;
+        }
+        else {
+            low = left;
+        }
+    }
+    return (low + high) / 2.0;
+}
+
+void computeGradient(const Dataset& data, const double* params, double K, int threadCount, std::vector<double>& gradient) {
+    std::vector<std::vector<double>> partial(threadCount, std::vector<double>(EVAL_PARAM_COUNT, 0.0));
+    parallelFor(data.positions.size(), threadCount, [&](size_t begin, size_t end, int t) {
+        std::vector<double>& local = partial[t];
+        for (size_t i = begin; i < end; i++) {
+            const TunerPosition& position = data.positions[i];
+            double s = sigmoid(evaluateTerms(data, position, params), K);
+            double factor = (s - position.result) * s * (1.0 - s);
+
+            const EvalTerm* terms = &data.terms[position.termOffset];
+            for (int j = 0; j < position.termCount; j++) {
+                local[terms[j].index] += factor * terms[j].coefficient;
+            }
+        }
+    });
+
+    //d/dw of the mean squared error, the constant factors fold into the learning rate
+    std::fill(gradient.begin(), gradient.end(), 0.0);
+    for (const std::vector<double>& local : partial) {
+        for (int i = 0; i < EVAL_PARAM_COUNT; i++) {
+            gradient[i] += local[i];
+        }
+    }
+    double scale = 2.0 * std::log(10.0) * K / 400.0 / data.positions.size();
+    for (double& g : gradient) g *= scale;
+}
+
+void writeTable(std::ofstream& out, const char* name, const int* table, bool last) {
+    out << "    { // " << name << "\n";
+    for (int row = 0; row < 8; row++) {
+        out << "    ";
+        for (int col = 0; col < 8; col++) {
+            out << std::setw(4) << table[row * 8 + col];
+            if (row != 7 || col != 7) out << ",";
+        }
+        out << "\n";
+    }
+    out << (last ? "    }\n" : "    },\n");
+}
+
+void writeHeader(const std::string& path, const double* params) {
+    int rounded[EVAL_PARAM_COUNT];
+    for (int i = 0; i < EVAL_PARAM_COUNT; i++) {
+        rounded[i] = int(std::lround(params[i]));
+    }
+
+    std::ofstream out(path);
+    out << "// Generated by the tuner target (Tools/Tuner.cpp). Do not edit by hand,\n"
+        << "// rerun the tuner on a labeled dataset to refresh these values.\n"
+        << "#pragma once\n\n"
+        << "constexpr int PIECE_VALUES[6] = {\n";
+    const char* names[6] = {"Pawn", "Knight", "Bishop", "Rook", "Queen", "King"};
+    for (int type = 0; type < 5; type++) {
+        out << "    " << rounded[PARAM_MATERIAL + type] << ",  // " << names[type] << "\n";
+    }
+    out << "    " << PIECE_VALUES[5] << " // King (arbitrary large)\n};\n\n"
+        << "constexpr int BISHOP_PAIR_BONUS = " << rounded[PARAM_BISHOP_PAIR] << ";\n\n"
+        << "constexpr int TEMPO_BONUS = " << rounded[PARAM_TEMPO] << ";\n\n"
+        << "//Tables are laid out as seen from white's side, rank 8 first\n"
+        << "constexpr int PIECE_SQUARE_TABLES[6][64] = {\n";
+    for (int type = 0; type < 6; type++) {
+        writeTable(out, names[type], &rounded[PARAM_PST + type * 64], type == 5);
+    }
+    out << "};\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: tuner <dataset.csv|dataset.epd> [output header] [epochs] [threads]" << std::endl;
+        return 1;
+    }
+    std::string datasetPath = argv[1];
+    std::string outputPath = argc > 2 ? argv[2] : "EvalParams.h";
+    int epochs = argc > 3 ? std::stoi(argv[3]) : 1000;
+    int threadCount = argc > 4 ? std::stoi(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+
+    Dataset data;
+    auto start = std::chrono::steady_clock::now();
+    if (datasetPath.size() >= 4 && datasetPath.substr(datasetPath.size() - 4) == ".csv") {
+        loadCSV(data, datasetPath);
+    }
+    else {
+        loadEPD(data, datasetPath);
+    }
+    if (data.positions.empty()) {
+        std::cerr << "No labeled positions found in " << datasetPath << std::endl;
+        return 1;
+    }
+    std::cout << "Loaded " << data.positions.size() << " positions in "
+        << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+
+    int initial[EVAL_PARAM_COUNT];
+    Evaluator::getParameters(initial);
+    std::vector<double> params(initial, initial + EVAL_PARAM_COUNT);
+
+    double K = findK(data, params.data(), threadCount);
+    std::cout << "K = " << K << ", error = " << meanSquaredError(data, params.data(), K, threadCount) << std::endl;
+
+    //Adam keeps the step size sensible for both material and square weights
+    const double learningRate = 1.0, beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> gradient(EVAL_PARAM_COUNT), momentum(EVAL_PARAM_COUNT, 0.0), velocity(EVAL_PARAM_COUNT, 0.0);
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        computeGradient(data, params.data(), K, threadCount, gradient);
+        for (int i = 0; i < EVAL_PARAM_COUNT; i++) {
+            momentum[i] = beta1 * momentum[i] + (1.0 - beta1) * gradient[i];
+            velocity[i] = beta2 * velocity[i] + (1.0 - beta2) * gradient[i] * gradient[i];
+            double correctedMomentum = momentum[i] / (1.0 - std::pow(beta1, epoch));
+            double correctedVelocity = velocity[i] / (1.0 - std::pow(beta2, epoch));
+            params[i] -= learningRate * correctedMomentum / (std::sqrt(correctedVelocity) + epsilon);
+        }
+
+        if (epoch % 50 == 0 || epoch == epochs) {
+            std::cout << "Epoch " << epoch << ", error = " << meanSquaredError(data, params.data(), K, threadCount) << std::endl;
+            writeHeader(outputPath, params.data());
+        }
+    }
+
+    std::cout << "Wrote " << outputPath << std::endl;
+    return 0;
+}
@@ -19,8 +19,12 @@
 #include "Engine/Search.h"
 #include "Engine/Evaluator.h"
 #include "Engine/TTEntry.h"
+#include "Engine/Trace.h"
 #include "tbprobe.h"
 #include "GUI/MultiplayerChessGUI.h"
+#include "GUI/NetworkSession.h"
+#include "GUI/RenderScheduler.h"
+#include "GUI/Assets.h"
 bool DEBUG = false;
 sf::RenderWindow window;
 sf::Vector2f windowSize;
@@ -30,10 +34,9 @@ void renderBotGUI();
 void renderLocalGUI();
 void renderJoinGameGUI();
 void renderHostGameGUI();
-void renderMultiplayerGameGUI(PieceColor color,sf::TcpSocket* socket);
-std::vector<uint8_t> serializeMove(const Move& move);
-Move deserializeMove(const uint8_t* data, size_t dataLength);
-sf::Font font;
+void renderMultiplayerGameGUI(PieceColor color, NetworkSession& session);
+//Owned by Assets, set once the window is up
+const sf::Font* font = nullptr;
 void printBitboard(uint64_t board) {
     std::bitset<64> bits(board);
     for (int rank = 7; rank >= 0; --rank) { // rank 8 to 1
@@ -54,24 +57,24 @@ bool comp(Move a, Move b){
 
 int main()
 {
-    MoveGenerator::initKnightAttacks();
-    MoveGenerator::initKingAttacks();
-    MoveGenerator::initSlidingAttacks();
-    MoveGenerator::initPawnAttacks();
-    Search::initOpeningTreeTXT();
-    if (!tb_init("../tablebases") ||TB_LARGEST == 0){
-        std::exception();
+    if (!Search::openingBook.open("book.bin")){
+        std::cout << "No opening book found, playing from search only" << std::endl;
     }
+    Search::initTablebasesAsync("../tablebases");
+    //Decodes the images, fonts and sounds while the engine and the window start up, the start screen's first
+    Assets::loadAsync("../assets", {"font/arial.ttf", "img/ChessWallpaper.png"});
     
     
     std::srand(std::time(0));
     if (DEBUG){
         Board board = Board();
-        board.parseFEN("2r1kb1r/1Q2p1pp/2pBq3/1p3pR1/5P2/8/P4P1P/3R1K2 w k - 0 1");
-        board.whiteToMove = false;
-        board.castlingRights = 0;
+        board.parseFEN("2r1kb1r/1Q2p1pp/2pBq3/1p3pR1/5P2/8/P4P1P/3R1K2 b - - 0 1");
         Search searcher = Search();
         std::cout << "Best move: " << searcher.findBestMoveIterative(board).toString() << std::endl;
+#ifdef ENGINE_TRACE
+        dumpTraceChrome("trace.json");
+        dumpTraceFolded("trace.folded");
+#endif
     }
     else{
         Board board = Board();
@@ -83,9 +86,7 @@ int main()
         windowSize = sf::Vector2f(window.getSize().x, window.getSize().y);
 
         window.setPosition(sf::Vector2i(0, 0));
-        if (!font.openFromFile("..\\assets\\font\\arial.ttf")){
-            throw std::invalid_argument("couldnt find file font arial");
-        }
+        font = &Assets::getFont("font/arial.ttf");
         window.setMouseCursorVisible(true);
         renderStartGUI();
     }
@@ -97,20 +98,17 @@ void renderStartGUI() {
     int clickEvent;
     // Load from a font file on disk
     
-    sf::Texture background;
-    if (!background.loadFromFile("..\\assets\\img\\ChessWallpaper.png")){
-        throw std::invalid_argument("couldnt find file wallpaper");
-    }
+    const sf::Texture& background = Assets::getTexture("img/ChessWallpaper.png");
 
     GUI startGUI = GUI(START,background);
     startGUI.setBackground(background, windowSize);
-    Button singleplayerButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.3), font, "SINGLEPLAYER", 70, sf::Color(255, 255, 255), sf::Color(200,200,200), 80);
+    Button singleplayerButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.3), *font, "SINGLEPLAYER", 70, sf::Color(255, 255, 255), sf::Color(200,200,200), 80);
     startGUI.buttons.emplace_back(singleplayerButton);
 
-    Button hostGameButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.5), font, "HOST GAME", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
+    Button hostGameButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.5), *font, "HOST GAME", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
     startGUI.buttons.emplace_back(hostGameButton);
 
-    Button joinGameButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.7), font, "JOIN GAME", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
+    Button joinGameButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.7), *font, "JOIN GAME", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
     startGUI.buttons.emplace_back(joinGameButton);
     
 
@@ -154,17 +152,14 @@ void renderStartGUI() {
 
 void renderSingleplayerGUI() {
     int clickEvent;
-    sf::Texture background;
-    if (!background.loadFromFile("..\\assets\\img\\ChessWallpaper.png")){
-        throw std::invalid_argument("couldnt find file wallpaper");
-    }
+    const sf::Texture& background = Assets::getTexture("img/ChessWallpaper.png");
 
     GUI singlePlayerGUI = GUI(SINGLEPLAYER,background);
     singlePlayerGUI.setBackground(background, windowSize);
-    Button playLocallyButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.4), font, "PLAY LOCALLY", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
+    Button playLocallyButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.4), *font, "PLAY LOCALLY", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
     singlePlayerGUI.buttons.emplace_back(playLocallyButton);
 
-    Button playBotButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.6), font, "PLAY AGAINST BOT", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
+    Button playBotButton = Button(sf::Vector2f(windowSize.x * 0.2, windowSize.y * 0.6), *font, "PLAY AGAINST BOT", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 80);
     singlePlayerGUI.buttons.emplace_back(playBotButton);
     std::optional<Button> clickedButton;
     while (window.isOpen())
@@ -202,6 +197,12 @@ void renderBotGUI() {
     board.setStartingPosition();
 
     Search moveFinder = Search();
+    uint64_t bookSeed = std::time(0);
+    moveFinder.newGame(bookSeed);
+    std::cout << "Book seed: " << bookSeed << std::endl;
+    //One JSON line of search statistics per bot move, for graphing search efficiency
+    std::ofstream statsLog("search_stats.jsonl", std::ios::app);
+    moveFinder.statsOutput = &statsLog;
 
     ChessGUI botGUI = ChessGUI(SINGLEPLAYER_BOT, board);
     botGUI.font = font;
@@ -210,7 +211,7 @@ void renderBotGUI() {
     
 
     
-    Button restoreMove = Button(sf::Vector2f(200,windowSize.y/2),font,"Undo Move",
+    Button restoreMove = Button(sf::Vector2f(200,windowSize.y/2),*font,"Undo Move",
     50,sf::Color(255,255,255),sf::Color(150,150,150),60);
 
     botGUI.buttons.emplace_back(restoreMove);
@@ -218,13 +219,15 @@ void renderBotGUI() {
     sf::Vector2i boardOffset(500, 50);
 
     std::optional<Button> clickedButton = std::nullopt;
+    RenderScheduler scheduler;
 
     while (window.isOpen())
     {
-
-
-        window.clear();
+        scheduler.waitForNextFrame();
         clickEvent = botGUI.updateClickEvent(clickEvent, botGUI.processEventsAndReturnOnClick(window));
+        if (botGUI.hadEvent) {
+            scheduler.requestRedraw();
+        }
 
 
         sf::Vector2i currentCoords = sf::Mouse::getPosition(window);
@@ -240,6 +243,14 @@ void renderBotGUI() {
             botGUI.chessboard.makeMove(bestMove);
             
         }
+
+        //Nothing changed on screen, only keep polling events
+        scheduler.watch(botGUI.chessboard.zobristHash);
+        if (!scheduler.shouldRedraw()) {
+            continue;
+        }
+
+        window.clear();
         botGUI.drawChessBoard(window, boardOffset);
 
         botGUI.drawSelectedPieceSquare(window, boardOffset);
@@ -275,15 +286,13 @@ void renderLocalGUI(){
     int clickEvent = -1;
     int newEvent;
     Board board = Board();
-    board.parseFEN("2r1kb1r/1Q2p1pp/2pBq3/1p3pR1/5P2/8/P4P1P/3R1K2 w k - 0 1");
-    board.whiteToMove = false;
-    board.castlingRights = 0;
+    board.parseFEN("2r1kb1r/1Q2p1pp/2pBq3/1p3pR1/5P2/8/P4P1P/3R1K2 b - - 0 1");
 
     ChessGUI localGUI = ChessGUI(SINGLEPLAYER_LOCAL, board);
     localGUI.font = font;
     //FEATURES BUTTONS
     
-    Button restoreMove = Button(sf::Vector2f(200,windowSize.y/2),font,"Undo Move",
+    Button restoreMove = Button(sf::Vector2f(200,windowSize.y/2),*font,"Undo Move",
     50,sf::Color(255,255,255),sf::Color(150,150,150),60);
 
     localGUI.buttons.emplace_back(restoreMove);
@@ -291,19 +300,27 @@ void renderLocalGUI(){
     sf::Vector2i boardOffset(500, 50);
 
     std::optional<Button> clickedButton = std::nullopt;
+    RenderScheduler scheduler;
 
     while (window.isOpen())
     {
-
-
-        window.clear();
+        scheduler.waitForNextFrame();
         clickEvent = localGUI.updateClickEvent(clickEvent, localGUI.processEventsAndReturnOnClick(window));
+        if (localGUI.hadEvent) {
+            scheduler.requestRedraw();
+        }
 
 
         sf::Vector2i currentCoords = sf::Mouse::getPosition(window);
 
         localGUI.processClick(clickEvent,window,boardOffset);
-        
+
+        scheduler.watch(localGUI.chessboard.zobristHash);
+        if (!scheduler.shouldRedraw()) {
+            continue;
+        }
+
+        window.clear();
         localGUI.drawChessBoard(window, boardOffset);
 
         localGUI.drawSelectedPieceSquare(window, boardOffset);
@@ -335,21 +352,14 @@ void renderLocalGUI(){
 
 void renderHostGameGUI() {
 
-    sf::TcpListener listener;
-    if (listener.listen(7777) != sf::Socket::Status::Done) {
-        std::cerr << "Failed to start the listener!" << std::endl;
-        return;
-    }
+    //The network thread accepts the client while the guide stays on screen
+    NetworkSession session(sf::IpAddress::Any, 7777, true);
+    session.start();
     std::cout << "Server is listening on port 7777..." << std::endl;
-    // Accept a client connection
-    sf::TcpSocket client;
     GUI hostGameGUI = GUI(MULTIPLAYER_HOST);
-    sf::Texture background;
-    if (!background.loadFromFile("..\\assets\\img\\ChessWallpaper.png")){
-        throw std::exception();
-    }
+    const sf::Texture& background = Assets::getTexture("img/ChessWallpaper.png");
     hostGameGUI.setBackground(background, windowSize);
-    sf::Text joinGuideString( font,"", 25);
+    sf::Text joinGuideString( *font,"", 25);
     joinGuideString.setString("To host a game, you have to use ngrok \n"
         "To activate ngrok, download it, go to its directory and write \n"
         " \"  ngrok tcp 7777 \" in the command line. After that, \n"
@@ -363,27 +373,34 @@ void renderHostGameGUI() {
     guideRect.setPosition(joinGuideString.getPosition() - sf::Vector2f(10, 10));
     guideRect.setFillColor(sf::Color(50, 50, 50));
 
-    
-
-
-    if (listener.accept(client) != sf::Socket::Status::Done) {
-        std::cerr << "Failed to accept the client connection!" << std::endl;
-        return;
-    }
-    std::cout << "Client connected!" << std::endl;
-    const std::string message = "Hello from the server!";
-    if (client.send(message.c_str(), message.size() + 1) != sf::Socket::Status::Done) {
-        std::cerr << "Failed to send message!" << std::endl;
-    }
+    //Nothing moves while waiting for the client, so the guide is only redrawn on input
+    RenderScheduler scheduler;
+    while (window.isOpen()) {
+        scheduler.waitForNextFrame();
+        ConnectionState state = session.getState();
+        if (state == ConnectionState::Failed) {
+            std::cerr << "Failed to start the listener!" << std::endl;
+            return;
+        }
+        if (state == ConnectionState::Connected) {
+            std::cout << "Client connected!" << std::endl;
+            renderMultiplayerGameGUI(white, session);
+            return;
+        }
 
-    // Receive data from the client
-    char buffer[128];
-    std::size_t received;
-    if (client.receive(buffer, sizeof(buffer), received) != sf::Socket::Status::Done) {
-        std::cerr << "Failed to receive message!" << std::endl;
+        hostGameGUI.processEventsAndReturnOnClick(window);
+        if (hostGameGUI.hadEvent) {
+            scheduler.requestRedraw();
+        }
+        if (!scheduler.shouldRedraw()) {
+            continue;
+        }
+        window.clear();
+        hostGameGUI.drawBackground(window);
+        window.draw(guideRect);
+        window.draw(joinGuideString);
+        window.display();
     }
-    std::cout << "Received from client: " << buffer << std::endl;
-    renderMultiplayerGameGUI(white, &client);
 }
 
 
@@ -391,10 +408,7 @@ void renderHostGameGUI() {
 void renderJoinGameGUI() {
 
     int clickEvent;
-    sf::Texture background;
-    if (!background.loadFromFile("..\\assets\\img\\ChessWallpaper.png")) {
-        std::cerr << "Failed to load background image." << std::endl;
-    }
+    const sf::Texture& background = Assets::getTexture("img/ChessWallpaper.png");
 
     GUI joinGameGUI = GUI(GUI_SCREENS(MULTIPLAYER_JOIN));
     joinGameGUI.setBackground(background, windowSize);
@@ -415,10 +429,10 @@ void renderJoinGameGUI() {
     portBox.text = "";
     joinGameGUI.textBoxes.emplace_back(portBox);
 
-    Button ipAddressJoin = Button(sf::Vector2f(880, 650), font, "Join", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 30.0);
+    Button ipAddressJoin = Button(sf::Vector2f(880, 650), *font, "Join", 70, sf::Color(255, 255, 255), sf::Color(200, 200, 200), 30.0);
     joinGameGUI.buttons.emplace_back(ipAddressJoin);
 
-    sf::Text joinGuideString(font,"",25);
+    sf::Text joinGuideString(*font,"",25);
     joinGuideString.setString("To join a friends game, ensure that they have hosted a game and that they have ngrok active. \n"
         "To activate ngrok, download it, go to its directory and write \n"
         " \"  ngrok tcp 7777 \" in the command line. After that, \n"
@@ -432,15 +446,27 @@ void renderJoinGameGUI() {
     guideRect.setPosition(joinGuideString.getPosition() - sf::Vector2f(10,10));
     guideRect.setFillColor(sf::Color(50, 50, 50));
     
-    bool connected = false;
-    bool gameReady = false;
+    std::unique_ptr<NetworkSession> session;
     std::optional<Button> clickedButton;
-    while (!gameReady && window.isOpen()) {
-
+    RenderScheduler scheduler;
+    while (window.isOpen()) {
+        scheduler.waitForNextFrame();
 
+        if (session && session->getState() == ConnectionState::Connected) {
+            std::cout << "Connected to server!" << std::endl;
+            // Launch multiplayer game GUI for the joiner (client plays black, for example)
+            renderMultiplayerGameGUI(black, *session);
+            return;
+        }
 
-        
+        //Buttons and text boxes react inside the render calls, so only input triggers a frame
         clickEvent = joinGameGUI.processEventsAndReturnOnClick(window);
+        if (joinGameGUI.hadEvent) {
+            scheduler.requestRedraw();
+        }
+        if (!scheduler.shouldRedraw()) {
+            continue;
+        }
         window.clear();
         joinGameGUI.drawBackground(window);
 
@@ -448,35 +474,19 @@ void renderJoinGameGUI() {
 
         joinGameGUI.renderTextBoxes(window, (clickEvent == 2));
 
-        if (clickedButton.has_value() && clickedButton.value().textString == "Join") {
-            sf::TcpSocket socket;
-
-            // Connect to the server (change this to your server's IP address)
-
-            if (socket.connect(sf::IpAddress::LocalHost , std::stoi(joinGameGUI.textBoxes[1].text)) != sf::Socket::Status::Done) {
-                std::cerr << "Failed to connect to the server!" << std::endl;
-                return;
+        if (clickedButton.has_value() && clickedButton.value().textString == "Join" && !session) {
+            std::optional<sf::IpAddress> address = joinGameGUI.textBoxes[0].text.empty()
+                ? sf::IpAddress::LocalHost : sf::IpAddress::resolve(joinGameGUI.textBoxes[0].text);
+            if (!address.has_value()) {
+                std::cerr << "Could not resolve " << joinGameGUI.textBoxes[0].text << std::endl;
             }
-            std::cout << "Connected to server!" << std::endl;
-            // Receive the message from the server
-            char buffer[128];
-            std::size_t received;
-            if (socket.receive(buffer, sizeof(buffer), received) != sf::Socket::Status::Done) {
-                std::cerr << "Failed to receive message!" << std::endl;
+            else {
+                //Connecting happens on the network thread, the screen keeps rendering meanwhile
+                session = std::make_unique<NetworkSession>(address.value(), std::stoi(joinGameGUI.textBoxes[1].text), false);
+                session->start();
             }
-            std::cout << "Received from server: " << buffer << std::endl;
-
-            // Send a message to the server
-            const std::string message = "Hello from the client!";
-            if (socket.send(message.c_str(), message.size() + 1) != sf::Socket::Status::Done) {
-                std::cerr << "Failed to send message!" << std::endl;
-            }
-            
-            // Launch multiplayer game GUI for the joiner (client plays black, for example)
-            renderMultiplayerGameGUI(black, &socket);
-            
+        }
 
-            }
         window.draw(guideRect);
         window.draw(joinGuideString);
         window.display();
@@ -484,8 +494,8 @@ void renderJoinGameGUI() {
 }
 
 // ----------renderMultiplayerGameGUI----------
-// Note: This version now takes pointers to the ENetPeer and ENetHost
-void renderMultiplayerGameGUI(PieceColor color,sf::TcpSocket* socket) {
+// Note: The session's network thread owns the socket, this loop only polls its queues
+void renderMultiplayerGameGUI(PieceColor color, NetworkSession& session) {
     int clickEvent = -1;
     Board board = Board();
     board.setStartingPosition();
@@ -498,22 +508,78 @@ void renderMultiplayerGameGUI(PieceColor color,sf::TcpSocket* socket) {
     sf::Vector2i boardOffset(500, 50);
     std::optional<Button> clickedButton = std::nullopt;
     std::optional<Move> moveMade = std::nullopt;
-    // Setup socket selector to monitor the socket for reading
-    sf::SocketSelector selector = sf::SocketSelector();
-    selector.add(*socket);  // Add socket to selector
-
-    bool sendPackage = true;
+    sf::Text connectionString(*font, "Connection lost, reconnecting...", 30);
+    connectionString.setPosition(sf::Vector2f(50, 50));
+
+    //Plies already sent or received, so every local move goes out exactly once
+    size_t sentPly = 0;
+    //Time used by white and black, sent along with every move
+    uint32_t clockMs[2] = {0, 0};
+    auto lastTick = std::chrono::steady_clock::now();
+    RenderScheduler scheduler;
+    ConnectionState lastState = session.getState();
     while (window.isOpen()) {
-        window.clear();
+        scheduler.waitForNextFrame();
 
         clickEvent = multiplayerGameGUI.updateClickEvent(clickEvent,
             multiplayerGameGUI.processEventsAndReturnOnClick(window));
+        if (multiplayerGameGUI.hadEvent) {
+            scheduler.requestRedraw();
+        }
 
         sf::Vector2i currentCoords = sf::Mouse::getPosition(window);
 
         // Assume processClick now returns an optional<Move> if a move was made
         multiplayerGameGUI.processClick(clickEvent, window, boardOffset);
 
+
+        //Handle multiplayer
+        PieceColor toMove = multiplayerGameGUI.chessboard.whiteToMove ? white : black;
+        std::vector<Move>& history = multiplayerGameGUI.chessboard.moveHistory;
+        auto now = std::chrono::steady_clock::now();
+        clockMs[toMove == white ? 0 : 1] += uint32_t(std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTick).count());
+        lastTick = now;
+
+        //Moves arrive through the session's queue, the frame never waits on the network
+        NetMessage message;
+        while (session.pollMove(message)) {
+            //Only the opponent's move for the current ply is accepted, anything else would desync the boards
+            Move moveToDo;
+            if (multiplayerGameGUI.clientColor == toMove || message.sequence != history.size()
+                || !decodeNetMove(multiplayerGameGUI.chessboard, message.move, moveToDo)) {
+                std::cerr << "Rejected move " << message.move << " for ply " << message.sequence << std::endl;
+                continue;
+            }
+            multiplayerGameGUI.chessboard.makeMove(moveToDo);
+            clockMs[0] = message.whiteClockMs;
+            clockMs[1] = message.blackClockMs;
+            sentPly = history.size();
+            toMove = multiplayerGameGUI.chessboard.whiteToMove ? white : black;
+        }
+        if (history.size() > sentPly && history.back().pieceColor == multiplayerGameGUI.clientColor) {
+            NetMessage moveMessage;
+            moveMessage.type = MessageType::Move;
+            moveMessage.sequence = uint32_t(history.size() - 1);
+            moveMessage.move = history.back().pack();
+            moveMessage.whiteClockMs = clockMs[0];
+            moveMessage.blackClockMs = clockMs[1];
+            //A full queue only means the peer is slow, the move goes out on a later frame
+            if (session.sendMove(moveMessage)) {
+                sentPly = history.size();
+            }
+        }
+
+        //Received moves change the hash, dropped or restored connections change the banner
+        scheduler.watch(multiplayerGameGUI.chessboard.zobristHash);
+        if (session.getState() != lastState) {
+            lastState = session.getState();
+            scheduler.requestRedraw();
+        }
+        if (!scheduler.shouldRedraw()) {
+            continue;
+        }
+
+        window.clear();
         multiplayerGameGUI.drawChessBoard(window, boardOffset);
         multiplayerGameGUI.drawSelectedPieceSquare(window, boardOffset);
         multiplayerGameGUI.drawPieces(window, boardOffset);
@@ -525,38 +591,8 @@ void renderMultiplayerGameGUI(PieceColor color,sf::TcpSocket* socket) {
 
         }
 
-
-        //Handle multiplayer
-        std::vector<uint8_t> buffer(1024);  // Allocate a buffer for up to 1024 bytes
-        std::size_t received;
-        // Set a timeout for socket activity (e.g., 100 milliseconds)
-        PieceColor toMove = multiplayerGameGUI.chessboard.whiteToMove ? white : black;
-        if (multiplayerGameGUI.clientColor != toMove) {
-            sf::Time timeout = sf::milliseconds(50);
-            if (selector.wait(timeout)) {
-                if (selector.isReady(*socket)) {
-                    // Socket is ready to read
-                    sf::Socket::Status status = socket->receive(buffer.data(), buffer.size(), received);
-                    if (status == sf::Socket::Status::Done) {
-                        Move moveToDo = deserializeMove(buffer.data(), 7 * sizeof(int));
-                        multiplayerGameGUI.chessboard.makeMove(moveToDo);
-                        sendPackage = true;
-                    }
-                }
-            }
-        }
-
-        if (multiplayerGameGUI.clientColor != toMove
-            && !multiplayerGameGUI.chessboard.moveHistory.empty()
-             && multiplayerGameGUI.chessboard.moveHistory.back().pieceColor == multiplayerGameGUI.clientColor
-            && sendPackage) {
-            std::vector<uint8_t> message = serializeMove(multiplayerGameGUI.chessboard.moveHistory.back());
-            sf::Socket::Status stat= socket->send(message.data(),message.size());
-            std::cout << "MESSAGE SENT" << std::endl;
-            if (stat == sf::Socket::Status::Error ){
-                throw std::exception();
-            }
-            sendPackage = false;
+        if (lastState != ConnectionState::Connected) {
+            window.draw(connectionString);
         }
 
 
@@ -564,65 +600,3 @@ void renderMultiplayerGameGUI(PieceColor color,sf::TcpSocket* socket) {
 
     }
 }
-
-
-std::vector<uint8_t> serializeMove(const Move& move) {
-    std::vector<uint8_t> buffer;
-
-    // Convert enum fields to int (assuming they are enums)
-    int pieceTypeVal = static_cast<int>(move.pieceType);
-    int pieceColorVal = static_cast<int>(move.pieceColor);
-    int from = move.from;
-    int to = move.to;
-    int pieceEatenType = static_cast<int>(move.pieceEatenType);
-    int enPassantSquare = move.isEnPassant;
-    int promotionPiece = static_cast<int>(move.promotionPiece);
-
-    // Helper lambda to append an int's bytes to the buffer
-    auto appendInt = [&buffer](int value) {
-        uint8_t bytes[sizeof(int)];
-        std::memcpy(bytes, &value, sizeof(int));
-        buffer.insert(buffer.end(), bytes, bytes + sizeof(int));
-        };
-
-    appendInt(pieceTypeVal);
-    appendInt(pieceColorVal);
-    appendInt(from);
-    appendInt(to);
-    appendInt(pieceEatenType);
-    appendInt(enPassantSquare);
-    appendInt(promotionPiece);
-    return buffer;
-}
-
-Move deserializeMove(const uint8_t* data, size_t dataLength) {
-    // Check if the packet is large enough: we expect 6 ints
-    if (dataLength < 7 * sizeof(int)) {
-        std::cerr << "Received packet is too small to contain a valid Move." << std::endl;
-        return Move(); // return a default move or handle error
-    }
-    int pieceTypeVal, pieceColorVal, from, to, pieceEaten, enPassant, promotion;
-    std::memcpy(&pieceTypeVal, data, sizeof(int));
-    data += sizeof(int);
-    std::memcpy(&pieceColorVal, data, sizeof(int));
-    data += sizeof(int);
-    std::memcpy(&from, data, sizeof(int));
-    data += sizeof(int);
-    std::memcpy(&to, data, sizeof(int));
-    data += sizeof(int);
-    std::memcpy(&pieceEaten, data, sizeof(int));
-    data += sizeof(int);
-    std::memcpy(&enPassant, data, sizeof(int));
-    data += sizeof(int);
-    std::memcpy(&promotion, data, sizeof(int));
-    return Move(
-        static_cast<PieceType>(pieceTypeVal),
-        static_cast<PieceColor>(pieceColorVal),
-        from,
-        to,
-        static_cast<PieceType>(promotion),
-        static_cast<PieceType>(pieceEaten),
-        static_cast<bool>(enPassant)
-
-    );
-}
\ No newline at end of file